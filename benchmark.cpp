@@ -203,6 +203,21 @@ void bench()
     });
     assertEquals(x11, x12);
     assertEquals(x11, x13);
+
+    std::cout << "OrderBy.Last" << std::endl;
+    auto x14 = test("->IEnumerable (copies)", [&]() {
+        return linq::make_enumerable(data)
+            .OrderBy(linq::asc([](const auto &val) noexcept { return val.map[0]; }))
+            .Select([](const auto &val) noexcept { return val.map[0]; })
+            .Last();
+    });
+    auto x15 = test("->IEnumerable (by_ref)", [&]() {
+        return linq::make_enumerable(data)
+            .OrderBy(linq::by_ref, linq::asc([](const auto &val) noexcept { return val.map[0]; }))
+            .Select([](const auto &val) noexcept { return val.map[0]; })
+            .Last();
+    });
+    assertEquals(x14, x15);
     std::cout << std::endl;
 
     // auto x16 = test("StressTest->IEnumerable (GroupBy)", [&]() {
@@ -247,7 +262,8 @@ void bench<user>()
             .Where([](const auto &val) noexcept { return val.groupId > 5; })
             .GroupBy(
                 [](const auto &key) noexcept { return key.groupId; },
-                [](const auto &key) { return key.created; });
+                [](const auto &key) { return key.created; })
+            .Count();
     });
 
     std::unordered_map<int, std::unordered_map<int, std::vector<user>>> group;
@@ -261,7 +277,8 @@ void bench<user>()
     auto x2 = test("->IEnumerable (OrderBy)", [&]() {
         return linq::make_enumerable(data)
             .Where([](const auto &val) noexcept { return val.groupId > 6; })
-            .OrderBy(linq::asc([](const auto &key) noexcept  { return key.groupId; }));
+            .OrderBy(linq::asc([](const auto &key) noexcept  { return key.groupId; }))
+            .Count();
     });
 
     auto x3 = test("->IEnumerable (OrderBy)", [&]() {
@@ -286,6 +303,33 @@ void bench<user>()
     //        .OrderBy(linq::make_asc([](const auto &key) noexcept { return key.groupId; }));
     //});
 
+    std::cout << "checksum: " << x0 + x2 << std::endl;
+    std::cout << std::endl;
+}
+
+void bench_parallel()
+{
+    std::vector<int> data(20000000);
+    for (auto &x : data)
+        x = (int)(std::rand() * 1000.0 / RAND_MAX);
+
+    auto const sequential = test("->Sequential (Where.Sum)", [&]() {
+        return linq::make_enumerable(data)
+            .Where([](const auto &val) noexcept { return val > 5; })
+            .Select([](const auto &val) noexcept { return (long long)val; })
+            .Sum();
+    });
+    for (std::size_t threads = 1; threads <= std::thread::hardware_concurrency(); threads *= 2)
+    {
+        auto const parallel = test("->AsParallel(" + std::to_string(threads) + ") (Where.Sum)", [&]() {
+            return linq::make_enumerable(data)
+                .AsParallel(threads)
+                .Where([](const auto &val) noexcept { return val > 5; })
+                .Select([](const auto &val) noexcept { return (long long)val; })
+                .Sum();
+        });
+        assertEquals(sequential, parallel);
+    }
     std::cout << std::endl;
 }
 
@@ -300,6 +344,9 @@ int main(int, char *[])
 
     std::cout << "# User objects" << std::endl;
     bench<user>();
+
+    std::cout << "# Parallel scaling" << std::endl;
+    bench_parallel();
     system("pause");
     return EXIT_SUCCESS;
 }
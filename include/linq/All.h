@@ -3,6 +3,163 @@
 
 namespace linq
 {
+    // materialized storage of GroupBy/OrderBy/All, built by the first enumeration
+    template<typename Container, typename Builder>
+    class deferred {
+    public:
+        typedef Container container_type;
+
+        deferred(Builder const &builder, Container &&container = Container())
+                : builder_(builder), container_(std::move(container)) {}
+
+        Container &get() {
+            std::call_once(built_, [this]() { builder_(container_); });
+            return container_;
+        }
+
+    private:
+        Builder const builder_;
+        std::once_flag built_;
+        Container container_;
+    };
+
+    // All(linq::by_ref)/OrderBy(linq::by_ref, keys...) store references to the source rows
+    // instead of copies, valid as long as the source container
+    struct by_ref_t {};
+    constexpr by_ref_t by_ref{};
+
+    // a materialized row of All/OrderBy by_ref; the sort reads its keys through row_value
+    template<typename T>
+    struct ref_row
+    {
+        ref_row() noexcept(true) : ptr(nullptr) {}
+        ref_row(T &in) noexcept(true) : ptr(std::addressof(in)) {}
+
+        T *ptr;
+    };
+
+    // a stored row is either a pointer to the source element or, for by_copy and for
+    // pipelines yielding temporaries, the element itself
+    template<typename Row>
+    struct row_traits
+    {
+        typedef Row const &reference;
+
+        template<typename In>
+        static constexpr Row make(In &&in) noexcept(true) { return Row(std::forward<In>(in)); }
+        static constexpr reference get(Row const &row) noexcept(true) { return row; }
+    };
+    template<typename T>
+    struct row_traits<T *>
+    {
+        typedef T &reference;
+
+        static constexpr T *make(T &in) noexcept(true) { return std::addressof(in); }
+        static constexpr reference get(T *row) noexcept(true) { return *row; }
+    };
+    template<typename T>
+    struct row_traits<ref_row<T>>
+    {
+        typedef T &reference;
+
+        static constexpr ref_row<T> make(T &in) noexcept(true) { return ref_row<T>(in); }
+        static constexpr reference get(ref_row<T> const &row) noexcept(true) { return *row.ptr; }
+    };
+
+    template<typename Row>
+    constexpr Row const &row_value(Row const &row) noexcept(true) { return row; }
+    template<typename T>
+    constexpr T &row_value(ref_row<T> const &row) noexcept(true) { return *row.ptr; }
+    template<typename Row>
+    using row_value_t = typename std::remove_reference<decltype(row_value(std::declval<Row const &>()))>::type;
+
+    template<typename In, bool ref>
+    using stored_row_t = typename std::conditional<ref && std::is_lvalue_reference<In>::value,
+                                                   ref_row<typename std::remove_reference<In>::type>,
+                                                   typename std::decay<In>::type>::type;
+
+    template<typename Row>
+    class row_it
+    {
+    public:
+        typedef std::random_access_iterator_tag        iterator_category;
+        typedef typename row_traits<Row>::reference    value_type;
+        typedef std::ptrdiff_t                         difference_type;
+        typedef typename std::remove_reference<value_type>::type *pointer;
+        typedef value_type                             reference;
+
+        row_it() = default;
+        row_it(Row const *row) noexcept(true) : row_(row) {}
+
+        constexpr reference operator*() const noexcept(true) { return row_traits<Row>::get(*row_); }
+        constexpr pointer operator->() const noexcept(true) { return std::addressof(operator*()); }
+        constexpr reference operator[](difference_type const n) const noexcept(true) { return row_traits<Row>::get(row_[n]); }
+
+        constexpr auto &operator++() noexcept(true) { ++row_; return (*this); }
+        constexpr auto operator++(int) noexcept(true) { auto tmp = *this; ++row_; return (tmp); }
+        constexpr auto &operator--() noexcept(true) { --row_; return (*this); }
+        constexpr auto operator--(int) noexcept(true) { auto tmp = *this; --row_; return (tmp); }
+        constexpr auto &operator+=(difference_type const n) noexcept(true) { row_ += n; return (*this); }
+        constexpr auto &operator-=(difference_type const n) noexcept(true) { row_ -= n; return (*this); }
+        constexpr auto operator+(difference_type const n) const noexcept(true) { return row_it(row_ + n); }
+        constexpr auto operator-(difference_type const n) const noexcept(true) { return row_it(row_ - n); }
+        constexpr difference_type operator-(row_it const &rhs) const noexcept(true) { return row_ - rhs.row_; }
+        friend constexpr auto operator+(difference_type const n, row_it const &rhs) noexcept(true) { return (rhs + n); }
+
+        constexpr bool operator==(row_it const &rhs) const noexcept(true) { return row_ == rhs.row_; }
+        constexpr bool operator!=(row_it const &rhs) const noexcept(true) { return row_ != rhs.row_; }
+        constexpr bool operator<(row_it const &rhs) const noexcept(true) { return row_ < rhs.row_; }
+        constexpr bool operator>(row_it const &rhs) const noexcept(true) { return row_ > rhs.row_; }
+        constexpr bool operator<=(row_it const &rhs) const noexcept(true) { return row_ <= rhs.row_; }
+        constexpr bool operator>=(row_it const &rhs) const noexcept(true) { return row_ >= rhs.row_; }
+
+    private:
+        Row const *row_;
+    };
+
+    template<typename Base>
+    struct bounds
+    {
+        template<typename Container>
+        static constexpr Base begin(Container &c) noexcept(true) { return c.begin(); }
+        template<typename Container>
+        static constexpr Base end(Container &c) noexcept(true) { return c.end(); }
+    };
+    template<typename Row>
+    struct bounds<row_it<Row>>
+    {
+        template<typename Container>
+        static constexpr row_it<Row> begin(Container &c) noexcept(true) { return row_it<Row>(c.data()); }
+        template<typename Container>
+        static constexpr row_it<Row> end(Container &c) noexcept(true) { return row_it<Row>(c.data() + c.size()); }
+    };
+    template<typename Base>
+    struct bounds<std::reverse_iterator<Base>>
+    {
+        template<typename Container>
+        static constexpr std::reverse_iterator<Base> begin(Container &c) noexcept(true) {
+            return std::reverse_iterator<Base>(bounds<Base>::end(c));
+        }
+        template<typename Container>
+        static constexpr std::reverse_iterator<Base> end(Container &c) noexcept(true) {
+            return std::reverse_iterator<Base>(bounds<Base>::begin(c));
+        }
+    };
+
+    // the iterator All exposes over a materialized container: by_ref rows are dereferenced
+    template<typename Container>
+    struct stored_it
+    {
+        typedef typename Container::iterator type;
+    };
+    template<typename T, typename Alloc>
+    struct stored_it<std::vector<ref_row<T>, Alloc>>
+    {
+        typedef row_it<ref_row<T>> type;
+    };
+    template<typename Container>
+    using stored_it_t = typename stored_it<Container>::type;
+
     template <typename Base, typename Proxy>
     class all_it : public Base {
     public:
@@ -16,34 +173,78 @@ namespace linq
         all_it() = delete;
         all_it(all_it const &) = default;
         all_it(Base const &base, Proxy proxy) noexcept(true)
-                : Base(base), proxy_(proxy)
+                : Base(base), proxy_(proxy), pending_(none)
+        {}
+        all_it(Proxy proxy, bool const end) noexcept(true)
+                : Base(), proxy_(proxy), pending_(end ? to_end : to_begin)
         {}
 
         constexpr auto const &operator=(all_it const &rhs) noexcept(true) {
-            static_cast<Base>(*this) = static_cast<Base const &>(rhs);
+            static_cast<Base &>(*this) = static_cast<Base const &>(rhs);
+            pending_ = rhs.pending_;
             return (*this);
         }
-        constexpr auto const &operator++() noexcept(true) {
+        constexpr auto const &operator++() noexcept(nothrow_range<Base>::value) {
             static_cast<Base &>(*this).operator++();
             return (*this);
         }
-        constexpr auto operator++(int) noexcept(true) {
+        constexpr auto operator++(int) noexcept(nothrow_range<Base>::value) {
             auto tmp = *this;
             operator++();
             return (tmp);
         }
-        constexpr auto const &operator--() noexcept(true) {
+        constexpr auto const &operator--() noexcept(nothrow_range<Base>::value) {
             static_cast<Base &>(*this).operator--();
             return (*this);
         }
-        constexpr auto operator--(int) noexcept(true) {
+        constexpr auto operator--(int) noexcept(nothrow_range<Base>::value) {
             auto tmp = *this;
             operator--();
             return (tmp);
         }
 
+        constexpr auto const &operator+=(difference_type const n) noexcept(nothrow_range<Base>::value) {
+            static_cast<Base &>(*this) += n;
+            return (*this);
+        }
+        constexpr auto const &operator-=(difference_type const n) noexcept(nothrow_range<Base>::value) {
+            static_cast<Base &>(*this) -= n;
+            return (*this);
+        }
+        constexpr auto operator+(difference_type const n) const noexcept(nothrow_range<Base>::value) {
+            auto tmp = *this;
+            tmp += n;
+            return (tmp);
+        }
+        constexpr auto operator-(difference_type const n) const noexcept(nothrow_range<Base>::value) {
+            auto tmp = *this;
+            tmp -= n;
+            return (tmp);
+        }
+        constexpr difference_type operator-(all_it const &rhs) const noexcept(nothrow_range<Base>::value) {
+            return static_cast<Base const &>(*this) - static_cast<Base const &>(rhs);
+        }
+        constexpr value_type operator[](difference_type const n) const noexcept(nothrow_range<Base>::value) {
+            return static_cast<Base const &>(*this)[n];
+        }
+        friend constexpr auto operator+(difference_type const n, all_it const &rhs) noexcept(nothrow_range<Base>::value) {
+            return (rhs + n);
+        }
+
+        constexpr void settle() {
+            if (pending_ != none)
+                static_cast<Base &>(*this) = pending_ == to_end ? bounds<Base>::end(proxy_->get())
+                                                                : bounds<Base>::begin(proxy_->get());
+            pending_ = none;
+        }
+
+        constexpr Proxy const &proxy() const noexcept(true) { return proxy_; }
+
     private:
+        enum pending { none, to_begin, to_end };
+
         Proxy proxy_;
+        pending pending_;
     };
 
     template<typename BaseIt, typename Proxy>
@@ -60,21 +261,30 @@ namespace linq
         All(BaseIt const &begin, BaseIt const &end, Proxy proxy)
                 : base_t(iterator(begin, proxy), iterator(end, proxy)), proxy_(proxy)
         {}
+        All(Proxy proxy)
+                : base_t(iterator(proxy, false), iterator(proxy, true)), proxy_(proxy)
+        {}
 
         constexpr auto asc() const noexcept(true) { return *this; }
         constexpr auto desc() const noexcept(true) {
-            return All<decltype(proxy_->rbegin()), Proxy>(proxy_->rbegin(), proxy_->rend(), proxy_);
+            return All<std::reverse_iterator<BaseIt>, Proxy>(proxy_);
         }
 
         template<typename Key>
         constexpr auto &operator[](Key const &key) const
         {
-            return (*proxy_).at(key);
+            return proxy_->get().at(key);
         }
 
     private:
         Proxy proxy_;
     };
+
+    template<typename Container, typename Builder>
+    constexpr auto make_all(Builder const &builder, Container &&container = Container()) noexcept(true) {
+        auto proxy = std::make_shared<deferred<Container, Builder>>(builder, std::move(container));
+        return All<stored_it_t<Container>, decltype(proxy)>(proxy);
+    }
 }
 
 #endif // !All_H_
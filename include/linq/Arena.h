@@ -0,0 +1,137 @@
+#ifndef ARENA_H_
+# define ARENA_H_
+
+namespace linq
+{
+    // monotonic buffer for the temporary storage of a query: allocation is a pointer bump,
+    // deallocation is a no-op and everything is released at once with the arena.
+    // Not thread-safe, give each concurrently running query its own arena
+    class arena
+    {
+        struct block
+        {
+            void *data;
+            std::size_t size;
+            bool mapped;
+        };
+    public:
+        enum options : unsigned
+        {
+            none = 0,
+            huge_pages = 1 << 0
+        };
+
+        explicit arena(std::size_t const chunk = 1 << 20, unsigned const options = none) noexcept(true)
+                : chunk_(chunk ? chunk : 1), options_(options) {}
+        arena(arena const &) = delete;
+        arena &operator=(arena const &) = delete;
+        ~arena() {
+            for (auto const &it : blocks_)
+                release(it);
+        }
+
+        void *allocate(std::size_t const size, std::size_t const align) {
+            auto cur = align_up(cur_, align);
+            if (!cur_ || cur + size > end_) {
+                grow(size + align);
+                cur = align_up(cur_, align);
+            }
+            cur_ = cur + size;
+            return reinterpret_cast<void *>(cur);
+        }
+
+        std::size_t reserved() const noexcept(true) {
+            std::size_t total = 0;
+            for (auto const &it : blocks_)
+                total += it.size;
+            return total;
+        }
+
+    private:
+        static constexpr std::size_t huge_page = std::size_t(2) << 20;
+
+        static std::uintptr_t align_up(std::uintptr_t const p, std::size_t const align) noexcept(true) {
+            return (p + align - 1) & ~static_cast<std::uintptr_t>(align - 1);
+        }
+
+        void grow(std::size_t const need) {
+            auto size = std::max(chunk_, need);
+            chunk_ *= 2;
+            block next{nullptr, size, false};
+#if defined(__linux__)
+            if (options_ & huge_pages) {
+                next.size = (size + huge_page - 1) / huge_page * huge_page;
+                next.data = ::mmap(nullptr, next.size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (next.data == MAP_FAILED)
+                    next.data = nullptr;
+                else {
+                    ::madvise(next.data, next.size, MADV_HUGEPAGE);
+                    next.mapped = true;
+                }
+            }
+#endif
+            if (!next.data) {
+                next.size = size;
+                next.data = ::operator new(size);
+            }
+            blocks_.push_back(next);
+            cur_ = reinterpret_cast<std::uintptr_t>(next.data);
+            end_ = cur_ + next.size;
+        }
+
+        static void release(block const &it) noexcept(true) {
+#if defined(__linux__)
+            if (it.mapped) {
+                ::munmap(it.data, it.size);
+                return;
+            }
+#endif
+            ::operator delete(it.data);
+        }
+
+        std::vector<block> blocks_;
+        std::uintptr_t cur_ = 0;
+        std::uintptr_t end_ = 0;
+        std::size_t chunk_;
+        unsigned const options_;
+    };
+
+    inline std::shared_ptr<arena> make_arena(std::size_t const chunk = 1 << 20, unsigned const options = arena::none) {
+        return std::make_shared<arena>(chunk, options);
+    }
+
+    // shares ownership of its arena: containers built with it keep the arena alive,
+    // so the storage of a query goes away with its last result
+    template<typename T>
+    class arena_allocator
+    {
+        template<typename>
+        friend class arena_allocator;
+    public:
+        typedef T value_type;
+        typedef std::true_type propagate_on_container_copy_assignment;
+        typedef std::true_type propagate_on_container_move_assignment;
+        typedef std::true_type propagate_on_container_swap;
+
+        arena_allocator(std::shared_ptr<arena> const &arena) noexcept(true)
+                : arena_(arena) {}
+        template<typename U>
+        arena_allocator(arena_allocator<U> const &rhs) noexcept(true)
+                : arena_(rhs.arena_) {}
+
+        T *allocate(std::size_t const n) {
+            return static_cast<T *>(arena_->allocate(n * sizeof(T), alignof(T)));
+        }
+        void deallocate(T *, std::size_t) noexcept(true) {}
+
+        template<typename U>
+        bool operator==(arena_allocator<U> const &rhs) const noexcept(true) { return arena_ == rhs.arena_; }
+        template<typename U>
+        bool operator!=(arena_allocator<U> const &rhs) const noexcept(true) { return arena_ != rhs.arena_; }
+
+    private:
+        std::shared_ptr<arena> arena_;
+    };
+}
+
+#endif // !ARENA_H_
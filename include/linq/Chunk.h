@@ -0,0 +1,177 @@
+#ifndef CHUNK_H_
+# define CHUNK_H_
+
+namespace linq
+{
+    // a batch of Chunk(n): size consecutive rows laid out contiguously, either in the source
+    // itself or in a buffer of the chunk iterator that the span keeps alive
+    template<typename T>
+    class span
+    {
+    public:
+        typedef T             value_type;
+        typedef pointer_it<T> iterator;
+        typedef iterator      const_iterator;
+
+        span() = default;
+        constexpr span(T *data, std::size_t const size, stage_context const &owner = nullptr) noexcept(true)
+                : data_(data), size_(size), owner_(owner) {}
+
+        constexpr iterator begin() const noexcept(true) { return iterator(data_); }
+        constexpr iterator end() const noexcept(true) { return iterator(data_ + size_); }
+        constexpr T *data() const noexcept(true) { return data_; }
+        constexpr std::size_t size() const noexcept(true) { return size_; }
+        constexpr bool empty() const noexcept(true) { return !size_; }
+        constexpr T &operator[](std::size_t const n) const noexcept(true) { return data_[n]; }
+        constexpr T &front() const noexcept(true) { return *data_; }
+        constexpr T &back() const noexcept(true) { return data_[size_ - 1]; }
+
+    private:
+        T *data_ = nullptr;
+        std::size_t size_ = 0;
+        stage_context owner_;
+    };
+
+    // chunks of a contiguous source are slices of it: nothing is copied and the chunks are
+    // random-access. The buffer is known once the bounds settle, the end position too
+    template<typename Base>
+    class span_chunk_it
+    {
+        using raw_t = typename kernel<Base>::raw_t;
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef span<raw_t>                     value_type;
+        typedef std::ptrdiff_t                  difference_type;
+        typedef value_type const                *pointer;
+        typedef value_type                      reference;
+
+        span_chunk_it() = delete;
+        span_chunk_it(Base const &begin, Base const &end, std::size_t const width, bool const last) noexcept(true)
+                : begin_(begin), end_(end), width_(width), last_(last) {}
+
+        constexpr value_type operator*() const noexcept(true) { return at(pos_); }
+        constexpr value_type operator[](difference_type const n) const noexcept(true) { return at(pos_ + n); }
+
+        constexpr auto &operator++() noexcept(true) { ++pos_; return (*this); }
+        constexpr auto operator++(int) noexcept(true) { auto tmp = *this; ++pos_; return (tmp); }
+        constexpr auto &operator--() noexcept(true) { --pos_; return (*this); }
+        constexpr auto operator--(int) noexcept(true) { auto tmp = *this; --pos_; return (tmp); }
+        constexpr auto &operator+=(difference_type const n) noexcept(true) { pos_ += n; return (*this); }
+        constexpr auto &operator-=(difference_type const n) noexcept(true) { pos_ -= n; return (*this); }
+        constexpr auto operator+(difference_type const n) const noexcept(true) { auto tmp = *this; tmp.pos_ += n; return (tmp); }
+        constexpr auto operator-(difference_type const n) const noexcept(true) { auto tmp = *this; tmp.pos_ -= n; return (tmp); }
+        constexpr difference_type operator-(span_chunk_it const &rhs) const noexcept(true) { return pos_ - rhs.pos_; }
+        friend constexpr auto operator+(difference_type const n, span_chunk_it const &rhs) noexcept(true) { return (rhs + n); }
+
+        constexpr bool operator==(span_chunk_it const &rhs) const noexcept(true) { return pos_ == rhs.pos_; }
+        constexpr bool operator!=(span_chunk_it const &rhs) const noexcept(true) { return pos_ != rhs.pos_; }
+        constexpr bool operator<(span_chunk_it const &rhs) const noexcept(true) { return pos_ < rhs.pos_; }
+        constexpr bool operator>(span_chunk_it const &rhs) const noexcept(true) { return pos_ > rhs.pos_; }
+        constexpr bool operator<=(span_chunk_it const &rhs) const noexcept(true) { return pos_ <= rhs.pos_; }
+        constexpr bool operator>=(span_chunk_it const &rhs) const noexcept(true) { return pos_ >= rhs.pos_; }
+
+        constexpr void settle() noexcept(true) {
+            linq::settle(begin_);
+            linq::settle(end_);
+            auto const data = kernel<Base>::data(begin_, end_);
+            data_ = data.first;
+            size_ = data.second;
+            if (last_)
+                pos_ = static_cast<difference_type>((size_ + width_ - 1) / width_);
+        }
+
+    private:
+        constexpr value_type at(difference_type const pos) const noexcept(true) {
+            auto const first = static_cast<std::size_t>(pos) * width_;
+            return value_type(data_ + first, std::min(width_, size_ - first));
+        }
+
+        Base begin_;
+        Base end_;
+        std::size_t width_;
+        bool last_;
+        raw_t *data_ = nullptr;
+        std::size_t size_ = 0;
+        difference_type pos_ = 0;
+    };
+
+    // chunks of any other pipeline are copied into a buffer of the iterator. The buffer is
+    // refilled in place unless a chunk handed out from it (or a copy of the iterator) still
+    // holds it, so a consumer that lets each chunk go before the next one allocates once
+    template<typename Base>
+    class chunk_it
+    {
+        using row_t = typename std::decay<decltype(*std::declval<Base>())>::type;
+    public:
+        typedef std::input_iterator_tag iterator_category;
+        typedef span<row_t>             value_type;
+        typedef std::ptrdiff_t          difference_type;
+        typedef value_type const        *pointer;
+        typedef value_type              reference;
+        typedef std::vector<row_t>      buffer_type;
+
+        chunk_it() = delete;
+        chunk_it(Base const &cur, Base const &end, std::size_t const width) noexcept(true)
+                : cur_(cur), end_(end), width_(width) {}
+
+        constexpr value_type operator*() const noexcept(nothrow_range<Base>::value) {
+            return empty() ? value_type() : value_type(buffer_->data(), buffer_->size(), buffer_);
+        }
+
+        constexpr auto &operator++() noexcept(nothrow_range<Base>::value) { fill(); return (*this); }
+        constexpr auto operator++(int) noexcept(nothrow_range<Base>::value) { auto tmp = *this; fill(); return (tmp); }
+
+        constexpr bool operator==(chunk_it const &rhs) const noexcept(nothrow_range<Base>::value) {
+            return cur_ == rhs.cur_ && empty() == rhs.empty();
+        }
+        constexpr bool operator!=(chunk_it const &rhs) const noexcept(nothrow_range<Base>::value) { return !operator==(rhs); }
+
+        constexpr void settle() noexcept(nothrow_range<Base>::value) {
+            linq::settle(cur_);
+            linq::settle(end_);
+            if (empty())
+                fill();
+        }
+
+        constexpr Base const &base() const noexcept(true) { return cur_; }
+        constexpr std::size_t width() const noexcept(true) { return width_; }
+        constexpr bool empty() const noexcept(true) { return !buffer_ || buffer_->empty(); }
+
+        // a cleared buffer nobody else holds, or a new one
+        static void reuse(std::shared_ptr<buffer_type> &buffer, std::size_t const width) {
+            if (buffer && buffer.use_count() == 1)
+                buffer->clear();
+            else {
+                buffer = std::make_shared<buffer_type>();
+                buffer->reserve(width);
+            }
+        }
+
+    private:
+        constexpr void fill() noexcept(nothrow_range<Base>::value) {
+            if (cur_ == end_) {
+                buffer_.reset();
+                return;
+            }
+            reuse(buffer_, width_);
+            for (; cur_ != end_ && buffer_->size() < width_; ++cur_)
+                buffer_->push_back(*cur_);
+        }
+
+        Base cur_;
+        Base end_;
+        std::size_t width_;
+        std::shared_ptr<buffer_type> buffer_;
+    };
+
+    // zero-copy when the pipeline is a plain contiguous buffer
+    template<typename It, typename = void>
+    struct is_span_source : std::false_type
+    {};
+    template<typename It>
+    struct is_span_source<It, typename std::enable_if<kernel<It>::value>::type>
+            : std::integral_constant<bool, kernel<It>::plain>
+    {};
+}
+
+#endif // !CHUNK_H_
@@ -0,0 +1,155 @@
+#ifndef CONCAT_H_
+# define CONCAT_H_
+
+namespace linq
+{
+    // walks the first range then the second one; while in the first range second_ waits on
+    // the second begin, after it first_ rests on the first end, so a position is the sum of
+    // both offsets and random access costs one branch
+    template<typename First, typename Second>
+    class concat_it
+    {
+        using first_t = decltype(*std::declval<First>());
+        using second_t = decltype(*std::declval<Second>());
+    public:
+        typedef min_category_t<typename std::iterator_traits<First>::iterator_category,
+                               typename std::iterator_traits<Second>::iterator_category> iterator_category;
+        typedef typename std::conditional<std::is_same<first_t, second_t>::value, first_t,
+                typename std::common_type<typename std::decay<first_t>::type,
+                                          typename std::decay<second_t>::type>::type>::type value_type;
+        typedef std::ptrdiff_t                                   difference_type;
+        typedef typename std::iterator_traits<First>::pointer    pointer;
+        typedef value_type                                       reference;
+
+        concat_it() = delete;
+        concat_it(concat_it const &) = default;
+        concat_it(First const &first, First const &firstEnd, Second const &secondBegin, Second const &second) noexcept(true)
+                : first_(first), firstEnd_(firstEnd), secondBegin_(secondBegin), second_(second) {}
+
+        constexpr auto const &operator=(concat_it const &rhs) noexcept(true) {
+            first_ = rhs.first_;
+            firstEnd_ = rhs.firstEnd_;
+            secondBegin_ = rhs.secondBegin_;
+            second_ = rhs.second_;
+            return (*this);
+        }
+
+        constexpr value_type operator*() const noexcept(nothrow_range<First>::value && nothrow_range<Second>::value) {
+            if (first_ != firstEnd_)
+                return *first_;
+            return *second_;
+        }
+        constexpr value_type operator[](difference_type const n) const noexcept(nothrow_range<First>::value && nothrow_range<Second>::value) { return *(*this + n); }
+
+        constexpr auto const &operator++() noexcept(nothrow_range<First>::value && nothrow_range<Second>::value) {
+            if (first_ != firstEnd_)
+                ++first_;
+            else
+                ++second_;
+            return (*this);
+        }
+        constexpr auto operator++(int) noexcept(nothrow_range<First>::value && nothrow_range<Second>::value) {
+            auto tmp = *this;
+            operator++();
+            return (tmp);
+        }
+        constexpr auto const &operator--() noexcept(nothrow_range<First>::value && nothrow_range<Second>::value) {
+            if (second_ != secondBegin_)
+                --second_;
+            else
+                --first_;
+            return (*this);
+        }
+        constexpr auto operator--(int) noexcept(nothrow_range<First>::value && nothrow_range<Second>::value) {
+            auto tmp = *this;
+            operator--();
+            return (tmp);
+        }
+        constexpr concat_it const &operator+=(difference_type const n) noexcept(nothrow_range<First>::value && nothrow_range<Second>::value) {
+            if (n < 0)
+                return operator-=(-n);
+            auto const left = firstEnd_ - first_;
+            if (n <= left)
+                first_ += n;
+            else {
+                first_ = firstEnd_;
+                second_ += n - left;
+            }
+            return (*this);
+        }
+        constexpr concat_it const &operator-=(difference_type const n) noexcept(nothrow_range<First>::value && nothrow_range<Second>::value) {
+            if (n < 0)
+                return operator+=(-n);
+            auto const done = second_ - secondBegin_;
+            if (n <= done)
+                second_ -= n;
+            else {
+                second_ = secondBegin_;
+                first_ -= n - done;
+            }
+            return (*this);
+        }
+        constexpr auto operator+(difference_type const n) const noexcept(nothrow_range<First>::value && nothrow_range<Second>::value) {
+            auto tmp = *this;
+            tmp += n;
+            return (tmp);
+        }
+        constexpr auto operator-(difference_type const n) const noexcept(nothrow_range<First>::value && nothrow_range<Second>::value) {
+            auto tmp = *this;
+            tmp -= n;
+            return (tmp);
+        }
+        constexpr difference_type operator-(concat_it const &rhs) const noexcept(nothrow_range<First>::value && nothrow_range<Second>::value) {
+            return (first_ - rhs.first_) + (second_ - rhs.second_);
+        }
+        friend constexpr auto operator+(difference_type const n, concat_it const &rhs) noexcept(nothrow_range<First>::value && nothrow_range<Second>::value) {
+            return (rhs + n);
+        }
+
+        constexpr bool operator==(concat_it const &rhs) const noexcept(nothrow_range<First>::value && nothrow_range<Second>::value) {
+            return first_ == rhs.first_ && second_ == rhs.second_;
+        }
+        constexpr bool operator!=(concat_it const &rhs) const noexcept(nothrow_range<First>::value && nothrow_range<Second>::value) { return !operator==(rhs); }
+        constexpr bool operator<(concat_it const &rhs) const noexcept(nothrow_range<First>::value && nothrow_range<Second>::value) { return *this - rhs < 0; }
+        constexpr bool operator>(concat_it const &rhs) const noexcept(nothrow_range<First>::value && nothrow_range<Second>::value) { return *this - rhs > 0; }
+        constexpr bool operator<=(concat_it const &rhs) const noexcept(nothrow_range<First>::value && nothrow_range<Second>::value) { return *this - rhs <= 0; }
+        constexpr bool operator>=(concat_it const &rhs) const noexcept(nothrow_range<First>::value && nothrow_range<Second>::value) { return *this - rhs >= 0; }
+
+        constexpr void settle() noexcept(nothrow_range<First>::value && nothrow_range<Second>::value) {
+            linq::settle(first_);
+            linq::settle(firstEnd_);
+            linq::settle(secondBegin_);
+            linq::settle(second_);
+        }
+
+        constexpr First const &first() const noexcept(true) { return first_; }
+        constexpr Second const &second() const noexcept(true) { return second_; }
+
+    private:
+        First first_;
+        First firstEnd_;
+        Second secondBegin_;
+        Second second_;
+    };
+
+    template<typename First, typename Second>
+    class Concat : public TState<concat_it<First, Second>> {
+    public:
+        typedef concat_it<First, Second> iterator;
+        typedef iterator const_iterator;
+
+        using base_t = TState<iterator>;
+    public:
+        ~Concat() = default;
+        Concat() = delete;
+        Concat(Concat const &rhs)
+                : base_t(static_cast<base_t const &>(rhs))
+        {}
+        Concat(First const &begin, First const &end, Second const &otherBegin, Second const &otherEnd,
+               stage_context const &context) noexcept(true)
+                : base_t(iterator(begin, end, otherBegin, otherBegin), iterator(end, end, otherBegin, otherEnd), context)
+        {}
+    };
+}
+
+#endif // !CONCAT_H_
@@ -0,0 +1,123 @@
+#ifndef DISTINCT_H_
+# define DISTINCT_H_
+
+namespace linq
+{
+    struct identity
+    {
+        template<typename T>
+        constexpr T &&operator()(T &&in) const noexcept(true) { return std::forward<T>(in); }
+    };
+
+    // first-occurrence memo of a Distinct stage, shared by its iterators and handles: each
+    // position is hashed once, as far as anyone enumerated, later passes only read its flag.
+    // Enumerations on several threads take turns on it, one position at a time
+    template<typename Key, typename Set>
+    class distinct_state
+    {
+    public:
+        distinct_state(Key const &key, stage_context const &upstream)
+                : key_(key), upstream_(upstream) {}
+
+        template<typename In>
+        bool first(std::size_t const index, In const &in) const {
+            std::lock_guard<std::mutex> lock(lock_);
+            if (index < first_.size())
+                return first_[index];
+            auto const inserted = seen_.insert(key_(in)).second;
+            first_.push_back(inserted);
+            return inserted;
+        }
+
+    private:
+        Key const key_;
+        stage_context const upstream_;
+        mutable std::mutex lock_;
+        mutable Set seen_;
+        mutable std::vector<std::uint8_t> first_;
+    };
+
+    template<typename BaseIt, typename Key>
+    using distinct_state_t = distinct_state<Key, typename set_type<typename std::decay<
+            decltype(std::declval<Key const &>()(*std::declval<BaseIt>()))>::type, default_allocator>::type>;
+
+    template <typename Base, typename State>
+    class distinct_it : public Base {
+    public:
+        typedef Base base;
+        typedef min_category_t<typename Base::iterator_category,
+                               std::forward_iterator_tag>        iterator_category;
+        typedef decltype(*std::declval<Base>())                    value_type;
+        typedef typename Base::difference_type                    difference_type;
+        typedef typename Base::pointer                            pointer;
+        typedef value_type                                         reference;
+
+        distinct_it() = delete;
+        distinct_it(distinct_it const &) = default;
+        distinct_it(Base const &base, Base const &end, std::shared_ptr<State const> const &state) noexcept(true)
+                : Base(base), end_(end), state_(state), index_(0) {}
+
+        constexpr auto const &operator=(distinct_it const &rhs) noexcept(true) {
+            static_cast<Base &>(*this) = static_cast<Base const &>(rhs);
+            end_ = rhs.end_;
+            state_ = rhs.state_;
+            index_ = rhs.index_;
+            return *this;
+        }
+        constexpr auto const &operator++() noexcept(nothrow_range<Base>::value) {
+            do
+            {
+                static_cast<Base &>(*this).operator++();
+                ++index_;
+            } while (static_cast<Base const &>(*this) != end_ && !state_->first(index_, *static_cast<Base const &>(*this)));
+            return *this;
+        }
+        constexpr auto operator++(int) noexcept(nothrow_range<Base>::value)
+        {
+            auto tmp = *this;
+            operator++();
+            return (tmp);
+        }
+
+        constexpr void settle() noexcept(nothrow_range<Base>::value) {
+            linq::settle(static_cast<Base &>(*this));
+            linq::settle(end_);
+            if (static_cast<Base const &>(*this) != end_)
+                state_->first(index_, *static_cast<Base const &>(*this));
+        }
+
+        constexpr State const &state() const noexcept(true) { return *state_; }
+        constexpr std::size_t index() const noexcept(true) { return index_; }
+
+    private:
+        Base end_;
+        std::shared_ptr<State const> state_;
+        std::size_t index_;
+    };
+
+    template<typename BaseIt, typename Key>
+    class Distinct : public TState<distinct_it<BaseIt, distinct_state_t<BaseIt, Key>>> {
+        using state_t = distinct_state_t<BaseIt, Key>;
+    public:
+        typedef distinct_it<BaseIt, state_t> iterator;
+        typedef iterator const_iterator;
+
+        using base_t = TState<iterator>;
+    public:
+        ~Distinct() = default;
+        Distinct() = delete;
+        Distinct(Distinct const &rhs)
+                : base_t(static_cast<base_t const &>(rhs))
+        {}
+        Distinct(BaseIt const &begin, BaseIt const &end, Key const &key, stage_context const &upstream)
+                : Distinct(begin, end, std::make_shared<state_t const>(key, upstream))
+        {}
+
+    private:
+        Distinct(BaseIt const &begin, BaseIt const &end, std::shared_ptr<state_t const> const &state) noexcept(true)
+                : base_t(iterator(begin, end, state), iterator(end, end, state), state)
+        {}
+    };
+}
+
+#endif // !DISTINCT_H_
@@ -0,0 +1,195 @@
+#ifndef FILE_H_
+# define FILE_H_
+
+namespace linq
+{
+    // random-access position over a raw array, for sources that are not containers
+    template<typename T>
+    class pointer_it
+    {
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef T                               &value_type;
+        typedef std::ptrdiff_t                  difference_type;
+        typedef T                               *pointer;
+        typedef T                               &reference;
+
+        pointer_it() = default;
+        explicit pointer_it(T *ptr) noexcept(true)
+                : ptr_(ptr) {}
+
+        constexpr T &operator*() const noexcept(true) { return *ptr_; }
+        constexpr T *operator->() const noexcept(true) { return ptr_; }
+        constexpr T &operator[](difference_type const n) const noexcept(true) { return ptr_[n]; }
+
+        constexpr auto &operator++() noexcept(true) { ++ptr_; return (*this); }
+        constexpr auto operator++(int) noexcept(true) { auto tmp = *this; ++ptr_; return (tmp); }
+        constexpr auto &operator--() noexcept(true) { --ptr_; return (*this); }
+        constexpr auto operator--(int) noexcept(true) { auto tmp = *this; --ptr_; return (tmp); }
+        constexpr auto &operator+=(difference_type const n) noexcept(true) { ptr_ += n; return (*this); }
+        constexpr auto &operator-=(difference_type const n) noexcept(true) { ptr_ -= n; return (*this); }
+        constexpr auto operator+(difference_type const n) const noexcept(true) { return pointer_it(ptr_ + n); }
+        constexpr auto operator-(difference_type const n) const noexcept(true) { return pointer_it(ptr_ - n); }
+        constexpr difference_type operator-(pointer_it const &rhs) const noexcept(true) { return ptr_ - rhs.ptr_; }
+        friend constexpr auto operator+(difference_type const n, pointer_it const &rhs) noexcept(true) { return (rhs + n); }
+
+        constexpr bool operator==(pointer_it const &rhs) const noexcept(true) { return ptr_ == rhs.ptr_; }
+        constexpr bool operator!=(pointer_it const &rhs) const noexcept(true) { return ptr_ != rhs.ptr_; }
+        constexpr bool operator<(pointer_it const &rhs) const noexcept(true) { return ptr_ < rhs.ptr_; }
+        constexpr bool operator>(pointer_it const &rhs) const noexcept(true) { return ptr_ > rhs.ptr_; }
+        constexpr bool operator<=(pointer_it const &rhs) const noexcept(true) { return ptr_ <= rhs.ptr_; }
+        constexpr bool operator>=(pointer_it const &rhs) const noexcept(true) { return ptr_ >= rhs.ptr_; }
+
+    private:
+        T *ptr_ = nullptr;
+    };
+
+    // read-only view of a whole file. On Linux the pages are mapped, not copied, and the
+    // kernel is told how they will be read; elsewhere the file is read into memory
+    class mapped_file
+    {
+    public:
+        enum options : unsigned
+        {
+            none = 0,
+            sequential = 1 << 0,
+            random = 1 << 1,
+            willneed = 1 << 2,
+            huge_pages = 1 << 3
+        };
+
+        explicit mapped_file(std::string const &path, unsigned const options = sequential | willneed) {
+#if defined(__linux__)
+            auto const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0)
+                fail(path, errno);
+            struct stat info;
+            if (::fstat(fd, &info) < 0) {
+                auto const error = errno;
+                ::close(fd);
+                fail(path, error);
+            }
+            size_ = static_cast<std::size_t>(info.st_size);
+            if (size_) {
+                data_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (data_ == MAP_FAILED) {
+                    auto const error = errno;
+                    data_ = nullptr;
+                    ::close(fd);
+                    fail(path, error);
+                }
+                advise(options);
+            }
+            // the mapping keeps the file alive
+            ::close(fd);
+#else
+            (void) options;
+            std::ifstream in(path, std::ios::binary | std::ios::ate);
+            if (!in)
+                throw std::runtime_error("linq::mapped_file: cannot open " + path);
+            size_ = static_cast<std::size_t>(in.tellg());
+            if (size_) {
+                data_ = ::operator new(size_);
+                in.seekg(0);
+                if (!in.read(static_cast<char *>(data_), static_cast<std::streamsize>(size_))) {
+                    ::operator delete(data_);
+                    throw std::runtime_error("linq::mapped_file: cannot read " + path);
+                }
+            }
+#endif
+        }
+        mapped_file(mapped_file const &) = delete;
+        mapped_file &operator=(mapped_file const &) = delete;
+        ~mapped_file() {
+            if (!data_)
+                return;
+#if defined(__linux__)
+            ::munmap(data_, size_);
+#else
+            ::operator delete(data_);
+#endif
+        }
+
+        void const *data() const noexcept(true) { return data_; }
+        std::size_t size() const noexcept(true) { return size_; }
+
+    private:
+#if defined(__linux__)
+        // error is the errno of the failed call, saved before any cleanup call overwrites it
+        [[noreturn]] static void fail(std::string const &path, int const error) {
+            throw std::system_error(error, std::generic_category(), "linq::mapped_file: " + path);
+        }
+
+        // hints only, a kernel that ignores them still serves the pages
+        void advise(unsigned const options) const noexcept(true) {
+            if (options & sequential)
+                ::madvise(data_, size_, MADV_SEQUENTIAL);
+            if (options & random)
+                ::madvise(data_, size_, MADV_RANDOM);
+            if (options & willneed)
+                ::madvise(data_, size_, MADV_WILLNEED);
+# if defined(MADV_HUGEPAGE)
+            if (options & huge_pages)
+                ::madvise(data_, size_, MADV_HUGEPAGE);
+# endif
+        }
+#endif
+
+        void *data_ = nullptr;
+        std::size_t size_ = 0;
+    };
+
+    // single pass over the fixed-size records of a binary stream: a record is read when the
+    // iterator moves onto it (the first one on the first enumeration) and lives in the
+    // iterator, so a query over it can be enumerated once. A read that fails ends the range,
+    // also when the stream throws; its state still tells why
+    template<typename T>
+    class record_it
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "records are read as raw bytes");
+    public:
+        typedef std::input_iterator_tag iterator_category;
+        typedef T const                 &value_type;
+        typedef std::ptrdiff_t          difference_type;
+        typedef T const                 *pointer;
+        typedef T const                 &reference;
+
+        record_it() = default;
+        explicit record_it(std::istream &in) noexcept(true)
+                : in_(&in) {}
+
+        constexpr T const &operator*() const noexcept(true) { return *operator->(); }
+        constexpr T const *operator->() const noexcept(true) { return reinterpret_cast<T const *>(&value_); }
+
+        constexpr auto &operator++() noexcept(true) { read(); return (*this); }
+        constexpr auto operator++(int) noexcept(true) { auto tmp = *this; read(); return (tmp); }
+
+        // both are at the end once the stream ran out
+        constexpr bool operator==(record_it const &rhs) const noexcept(true) { return in_ == rhs.in_; }
+        constexpr bool operator!=(record_it const &rhs) const noexcept(true) { return in_ != rhs.in_; }
+
+        constexpr void settle() noexcept(true) {
+            if (in_ && !read_)
+                read();
+        }
+
+    private:
+        void read() noexcept(true) {
+            read_ = true;
+            try {
+                if (in_->read(reinterpret_cast<char *>(&value_), sizeof(T)))
+                    return;
+            } catch (...) {
+                // streams with exceptions enabled throw where others set a flag
+            }
+            in_ = nullptr;
+        }
+
+        std::istream *in_ = nullptr;
+        bool read_ = false;
+        // raw bytes, records need not be default-constructible
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type value_;
+    };
+}
+
+#endif // !FILE_H_
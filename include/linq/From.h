@@ -20,28 +20,59 @@ namespace linq
         {}
 
         constexpr auto const &operator=(basic_it const &rhs) noexcept(true) {
-            static_cast<Base>(*this) = static_cast<Base const &>(rhs);
+            static_cast<Base &>(*this) = static_cast<Base const &>(rhs);
             return *this;
         }
-        constexpr auto const &operator++() noexcept(true) {
+        constexpr auto const &operator++() noexcept(nothrow_range<Base>::value) {
             static_cast<Base &>(*this).operator++();
             return (*this);
         }
-        constexpr auto operator++(int) noexcept(true) {
+        constexpr auto operator++(int) noexcept(nothrow_range<Base>::value) {
             auto tmp = *this;
             operator++();
             return (tmp);
         }
-        constexpr auto const &operator--() noexcept(true) {
+        constexpr auto const &operator--() noexcept(nothrow_range<Base>::value) {
             static_cast<Base &>(*this).operator--();
             return (*this);
         }
-        constexpr auto operator--(int) noexcept(true) {
+        constexpr auto operator--(int) noexcept(nothrow_range<Base>::value) {
             auto tmp = *this;
             operator--();
             return (tmp);
         }
 
+        constexpr auto const &operator+=(difference_type const n) noexcept(nothrow_range<Base>::value) {
+            static_cast<Base &>(*this) += n;
+            return (*this);
+        }
+        constexpr auto const &operator-=(difference_type const n) noexcept(nothrow_range<Base>::value) {
+            static_cast<Base &>(*this) -= n;
+            return (*this);
+        }
+        constexpr auto operator+(difference_type const n) const noexcept(nothrow_range<Base>::value) {
+            auto tmp = *this;
+            tmp += n;
+            return (tmp);
+        }
+        constexpr auto operator-(difference_type const n) const noexcept(nothrow_range<Base>::value) {
+            auto tmp = *this;
+            tmp -= n;
+            return (tmp);
+        }
+        constexpr difference_type operator-(basic_it const &rhs) const noexcept(nothrow_range<Base>::value) {
+            return static_cast<Base const &>(*this) - static_cast<Base const &>(rhs);
+        }
+        constexpr value_type operator[](difference_type const n) const noexcept(nothrow_range<Base>::value) {
+            return static_cast<Base const &>(*this)[n];
+        }
+        friend constexpr auto operator+(difference_type const n, basic_it const &rhs) noexcept(nothrow_range<Base>::value) {
+            return (rhs + n);
+        }
+
+        constexpr void settle() noexcept(nothrow_range<Base>::value) {
+            linq::settle(static_cast<Base &>(*this));
+        }
     };
 
     template<typename BaseIt>
@@ -57,8 +88,8 @@ namespace linq
         ~From() = default;
         From() = delete;
         From(From const &) = default;
-        From(BaseIt const &begin, BaseIt const &end) noexcept(true)
-                : base_t(begin, end)
+        From(BaseIt const &begin, BaseIt const &end, stage_context const &context = nullptr) noexcept(true)
+                : base_t(begin, end, context)
         {}
     };
 }
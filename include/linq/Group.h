@@ -0,0 +1,413 @@
+#ifndef GROUP_H_
+# define GROUP_H_
+
+namespace linq
+{
+    // GroupBy(linq::by_copy, keys...) stores copies even when the source hands out references
+    struct by_copy_t {};
+    constexpr by_copy_t by_copy{};
+
+    // below it the pool costs more than it saves
+    constexpr std::size_t parallel_group_threshold = 1 << 15;
+
+    // one leaf group: a slice of the rows shared by every group of the same GroupBy
+    template<typename Row>
+    class group_range
+    {
+    public:
+        typedef Row         row_type;
+        typedef row_it<Row> iterator;
+        typedef iterator    const_iterator;
+        typedef typename row_traits<Row>::reference reference;
+
+        group_range() = default;
+        constexpr group_range(Row const *rows, std::size_t const offset, std::size_t const size) noexcept(true)
+                : rows_(rows), offset_(offset), size_(size) {}
+
+        constexpr iterator begin() const noexcept(true) { return iterator(rows_ + offset_); }
+        constexpr iterator end() const noexcept(true) { return iterator(rows_ + offset_ + size_); }
+        constexpr std::size_t size() const noexcept(true) { return size_; }
+        constexpr bool empty() const noexcept(true) { return !size_; }
+        constexpr reference operator[](std::size_t const n) const noexcept(true) { return begin()[n]; }
+        constexpr reference front() const noexcept(true) { return *begin(); }
+        constexpr reference back() const noexcept(true) { return end()[-1]; }
+
+    private:
+        template<typename>
+        friend class grouping;
+
+        static constexpr std::size_t unset = std::numeric_limits<std::size_t>::max();
+
+        Row const *rows_ = nullptr;
+        std::size_t offset_ = unset;
+        std::size_t size_ = 0;
+    };
+
+    template<typename Map, typename Key, typename Init>
+    auto &find_or_emplace(Map &map, Key const &key, Init const &init) {
+        auto const it = map.find(key);
+        return it != map.end() ? it->second : map.emplace(key, init()).first->second;
+    }
+
+    // one map level per key, down to a Leaf per distinct key path; leaves are created from init()
+    template<typename Leaf, typename Alloc, typename In, typename KeyLoader = void, typename... Funcs>
+    struct group_by
+    {
+        using Out = typename std::decay<decltype(std::declval<KeyLoader>()(std::declval<In>()))>::type;
+        typedef Leaf leaf_type;
+        typedef Alloc allocator_type;
+        typedef typename group_by<Leaf, Alloc, In, Funcs...>::type next_type;
+        typedef typename map_type<Out, next_type, Alloc, is_hashable<Out>::value>::type type;
+
+        template<typename Init>
+        static Leaf &leaf(type &handle, In const &val, Init const &init, KeyLoader const &func, Funcs const &...funcs) {
+            using next = group_by<Leaf, Alloc, In, Funcs...>;
+            return next::leaf(next::slot(handle, func(val), init), val, init, funcs...);
+        }
+        template<typename Map, typename Key, typename Init>
+        static type &slot(Map &parent, Key const &key, Init const &) {
+            return find_or_emplace(parent, key, [&parent] { return type(typename type::allocator_type(parent.get_allocator())); });
+        }
+        // the leaf of a key path computed beforehand, I is the level of handle
+        template<std::size_t I, typename Path, typename Init>
+        static Leaf &path_leaf(type &handle, Path const &path, Init const &init) {
+            using next = group_by<Leaf, Alloc, In, Funcs...>;
+            return next::template path_leaf<I + 1>(next::slot(handle, std::get<I>(path), init), path, init);
+        }
+
+        template<typename Visit>
+        static void visit(type &handle, Visit const &visit) {
+            for (auto &it : handle)
+                group_by<Leaf, Alloc, In, Funcs...>::visit(it.second, visit);
+        }
+    };
+    template<typename Leaf, typename Alloc, typename In>
+    struct group_by<Leaf, Alloc, In>
+    {
+        typedef Leaf leaf_type;
+        typedef Alloc allocator_type;
+        typedef Leaf type;
+
+        template<typename Init>
+        static type &leaf(type &handle, In const &, Init const &) noexcept(true) { return handle; }
+        template<typename Map, typename Key, typename Init>
+        static type &slot(Map &parent, Key const &key, Init const &init) { return find_or_emplace(parent, key, init); }
+        template<std::size_t I, typename Path, typename Init>
+        static type &path_leaf(type &handle, Path const &, Init const &) noexcept(true) { return handle; }
+
+        template<typename Visit>
+        static void visit(type &handle, Visit const &visit) { visit(handle); }
+    };
+
+    // nested key maps over one CSR row array: rows are bucketed by group in a single
+    // counting pass, so each group is contiguous and costs no allocation of its own
+    template<typename GroupBy>
+    class grouping
+    {
+        typedef typename GroupBy::leaf_type::row_type Row;
+        typedef typename GroupBy::allocator_type Alloc;
+        typedef typename GroupBy::type map_t;
+
+        template<typename T>
+        using vector_t = std::vector<T, rebind_alloc_t<Alloc, T>>;
+    public:
+        explicit grouping(Alloc const &alloc)
+                : map_(typename map_t::allocator_type(alloc)), rows_(alloc) {}
+
+        typedef typename map_t::iterator       iterator;
+        typedef typename map_t::const_iterator const_iterator;
+
+        iterator begin() noexcept(true) { return map_.begin(); }
+        iterator end() noexcept(true) { return map_.end(); }
+        auto rbegin() noexcept(true) { return map_.rbegin(); }
+        auto rend() noexcept(true) { return map_.rend(); }
+        std::size_t size() const noexcept(true) { return map_.size(); }
+
+        template<typename Key>
+        auto &at(Key const &key) { return map_.at(key); }
+        // the leaf of a single-key grouping, null when the key has no rows
+        template<typename Key>
+        auto const *find(Key const &key) const {
+            auto const it = map_.find(key);
+            return it != map_.end() ? std::addressof(it->second) : nullptr;
+        }
+
+        template<typename It, typename... Funcs>
+        void build(It const &begin, It const &end, Funcs const &...keys) {
+            using In = typename It::value_type;
+            auto const alloc = rows_.get_allocator();
+            vector_t<std::size_t> counts(alloc);
+            vector_t<std::pair<Row, std::size_t>> staged(alloc);
+            auto const hint = size_range(begin, end);
+            if (hint.exact)
+                staged.reserve(hint.size);
+
+            push_range(begin, end, [this, &counts, &staged, &hint, &keys...](In it) {
+                auto &leaf = GroupBy::leaf(map_, it, [] { return group_range<Row>(); }, keys...);
+                if (leaf.offset_ == group_range<Row>::unset) {
+                    leaf.offset_ = counts.size();
+                    counts.push_back(0);
+                }
+                ++counts[leaf.offset_];
+                push_bounded(staged, std::make_pair(row_traits<Row>::make(std::forward<In>(it)), leaf.offset_), hint.size);
+                return true;
+            });
+
+            vector_t<std::size_t> starts(counts.size(), 0, alloc);
+            std::size_t offset = 0;
+            for (std::size_t id = 0; id < counts.size(); ++id) {
+                starts[id] = offset;
+                offset += counts[id];
+            }
+            vector_t<std::size_t> order(staged.size(), 0, alloc);
+            {
+                auto cursor = starts;
+                for (std::size_t i = 0; i < staged.size(); ++i)
+                    order[cursor[staged[i].second]++] = i;
+            }
+            rows_.reserve(staged.size());
+            for (auto const i : order)
+                rows_.push_back(std::move(staged[i].first));
+
+            GroupBy::visit(map_, [this, &counts, &starts](group_range<Row> &leaf) {
+                leaf.rows_ = rows_.data();
+                leaf.size_ = counts[leaf.offset_];
+                leaf.offset_ = starts[leaf.offset_];
+            });
+        }
+
+        // on the pool when the source splits and the rows and keys allow it
+        template<typename It, typename... Funcs>
+        void build(It const &begin, It const &end, thread_pool &pool, std::size_t const threads, Funcs const &...keys) {
+            using In = typename It::value_type;
+            using parallel = std::integral_constant<bool, splitter<It>::value && std::is_default_constructible<Row>::value &&
+                    is_hashable_path<typename std::decay<decltype(keys(std::declval<In>()))>::type...>::value>;
+            build(begin, end, pool, threads, parallel{}, keys...);
+        }
+
+    private:
+        template<typename It, typename... Funcs>
+        void build(It const &begin, It const &end, thread_pool &, std::size_t, std::false_type, Funcs const &...keys) {
+            build(begin, end, keys...);
+        }
+        // every part of the source fills a partial table of its own, then the partial groups
+        // are merged by hash partition, each partition on one thread and in part order. The
+        // groups come out in order of first appearance and the rows of a group in source
+        // order, as with the sequential build
+        template<typename It, typename... Funcs>
+        void build(It const &begin, It const &end, thread_pool &pool, std::size_t const threads, std::true_type,
+                   Funcs const &...keys) {
+            using In = typename It::value_type;
+            using path_t = std::tuple<typename std::decay<decltype(keys(std::declval<In>()))>::type...>;
+            // the temporaries are filled on the workers and stay off the query allocator
+            struct partial
+            {
+                flat_map<path_t, std::size_t, hasher<path_t>> table; // path -> rows, indexed by local group
+                std::vector<std::pair<Row, std::uint32_t>> staged;
+                std::vector<std::vector<std::uint32_t>> partitions;   // local groups by path hash
+                std::vector<std::uint32_t> merged;                    // local group -> group of its partition
+                std::vector<std::size_t> cursor;                      // local group -> next slot in rows_
+            };
+            struct merged_group
+            {
+                std::size_t part;
+                std::uint32_t local;
+                std::size_t size;
+            };
+
+            if (threads < 2 || size_range(begin, end).size < parallel_group_threshold) {
+                build(begin, end, keys...);
+                return;
+            }
+            auto const parts = threads * 4;
+            std::vector<partial> partials(parts);
+            pool.run(parts, [&](std::size_t const part) {
+                auto &local = partials[part];
+                auto const range = splitter<It>::slice(begin, end, part, parts);
+                push_range(range.first, range.second, [&local, &keys...](In it) {
+                    auto const slot = local.table.emplace(path_t(keys(it)...), 0).first;
+                    ++slot->second;
+                    local.staged.emplace_back(row_traits<Row>::make(std::forward<In>(it)),
+                                              static_cast<std::uint32_t>(slot - local.table.begin()));
+                    return true;
+                });
+                local.partitions.resize(parts);
+                hasher<path_t> const hash;
+                for (std::size_t id = 0; id < local.table.size(); ++id)
+                    local.partitions[hash(local.table.begin()[id].first) % parts].push_back(static_cast<std::uint32_t>(id));
+                local.merged.resize(local.table.size());
+                local.cursor.resize(local.table.size());
+            });
+
+            // a partition sees the partial groups of its paths, part after part: the first one
+            // holds the first row, the others count the rows before theirs
+            std::vector<std::vector<merged_group>> groups(parts);
+            pool.run(parts, [&](std::size_t const partition) {
+                flat_map<path_t, std::uint32_t, hasher<path_t>> table;
+                auto &merged = groups[partition];
+                for (std::size_t part = 0; part < parts; ++part) {
+                    auto &local = partials[part];
+                    for (auto const id : local.partitions[partition]) {
+                        auto const &entry = local.table.begin()[id];
+                        auto const slot = table.emplace(entry.first, static_cast<std::uint32_t>(merged.size()));
+                        if (slot.second)
+                            merged.push_back(merged_group{part, id, 0});
+                        auto &group = merged[slot.first->second];
+                        local.merged[id] = slot.first->second;
+                        local.cursor[id] = group.size;
+                        group.size += entry.second;
+                    }
+                }
+            });
+
+            // the key maps are built in order of first appearance, so their iteration order
+            // is the one of the sequential build; a group's rows start where its leaf says
+            std::vector<std::pair<std::size_t, std::uint32_t>> order;
+            std::vector<std::vector<std::size_t>> starts(parts);
+            for (std::size_t partition = 0; partition < parts; ++partition) {
+                starts[partition].resize(groups[partition].size());
+                for (std::size_t id = 0; id < groups[partition].size(); ++id)
+                    order.emplace_back(partition, static_cast<std::uint32_t>(id));
+            }
+            std::sort(order.begin(), order.end(), [&groups](auto const &l, auto const &r) {
+                auto const &lhs = groups[l.first][l.second];
+                auto const &rhs = groups[r.first][r.second];
+                return lhs.part < rhs.part || (lhs.part == rhs.part && lhs.local < rhs.local);
+            });
+            std::size_t size = 0;
+            for (auto const &it : partials)
+                size += it.staged.size();
+            rows_.resize(size);
+            std::size_t offset = 0;
+            for (auto const &it : order) {
+                auto const &group = groups[it.first][it.second];
+                auto const &path = partials[group.part].table.begin()[group.local].first;
+                auto &leaf = GroupBy::template path_leaf<0>(map_, path, [] { return group_range<Row>(); });
+                leaf.rows_ = rows_.data();
+                leaf.offset_ = offset;
+                leaf.size_ = group.size;
+                starts[it.first][it.second] = offset;
+                offset += group.size;
+            }
+
+            pool.run(parts, [&](std::size_t const part) {
+                auto &local = partials[part];
+                for (std::size_t partition = 0; partition < parts; ++partition)
+                    for (auto const id : local.partitions[partition])
+                        local.cursor[id] += starts[partition][local.merged[id]];
+                for (auto &it : local.staged)
+                    rows_[local.cursor[it.second]++] = std::move(it.first);
+            });
+        }
+
+        map_t map_;
+        vector_t<Row> rows_;
+    };
+
+    template<typename In, bool copy>
+    using group_row_t = typename std::conditional<!copy && std::is_lvalue_reference<In>::value,
+                                                  typename std::remove_reference<In>::type *,
+                                                  typename std::decay<In>::type>::type;
+
+    template<typename Iterator, typename Row, typename Alloc, typename... Funcs>
+    class group_builder
+    {
+        using In = typename Iterator::value_type;
+    public:
+        typedef grouping<group_by<group_range<Row>, Alloc, In, Funcs...>> container_type;
+
+        group_builder(TState<Iterator> const &source, Alloc const &alloc, Funcs const &...keys)
+                : source_(source), alloc_(alloc), keys_(keys...) {}
+
+        container_type container() const { return container_type(alloc_); }
+        template<typename Map>
+        Map map() const { return Map(typename Map::allocator_type(alloc_)); }
+
+        group_builder parallel(thread_pool &pool, std::size_t const threads) const noexcept(true) {
+            auto ret = *this;
+            ret.pool_ = &pool;
+            ret.threads_ = threads;
+            return ret;
+        }
+
+        void operator()(container_type &out) const {
+            build(out, std::index_sequence_for<Funcs...>{});
+        }
+
+        // one accumulator per key path, folded as rows stream by
+        template<typename Acc, typename Fold>
+        void aggregate(typename group_by<Acc, Alloc, In, Funcs...>::type &out, Acc const &seed, Fold const &fold) const {
+            aggregate(out, seed, fold, std::index_sequence_for<Funcs...>{});
+        }
+
+    private:
+        template<std::size_t... I>
+        void build(container_type &out, std::index_sequence<I...>) const {
+            if (pool_)
+                out.build(source_.begin(), source_.end(), *pool_, threads_, std::get<I>(keys_)...);
+            else
+                out.build(source_.begin(), source_.end(), std::get<I>(keys_)...);
+        }
+        template<typename Acc, typename Fold, std::size_t... I>
+        void aggregate(typename group_by<Acc, Alloc, In, Funcs...>::type &out, Acc const &seed, Fold const &fold,
+                       std::index_sequence<I...>) const {
+            auto const init = [&seed] { return seed; };
+            push_range(source_.begin(), source_.end(), [this, &out, &init, &fold](In it) {
+                auto &acc = group_by<Acc, Alloc, In, Funcs...>::leaf(out, it, init, std::get<I>(keys_)...);
+                acc = fold(std::move(acc), it);
+                return true;
+            });
+        }
+
+        TState<Iterator> source_;
+        Alloc alloc_;
+        std::tuple<Funcs...> keys_;
+        thread_pool *pool_ = nullptr;
+        std::size_t threads_ = 1;
+    };
+
+    template<typename Iterator, typename Row, typename Alloc, typename... Funcs>
+    using group_proxy = std::shared_ptr<deferred<typename group_builder<Iterator, Row, Alloc, Funcs...>::container_type,
+                                                 group_builder<Iterator, Row, Alloc, Funcs...>>>;
+
+    template<typename Iterator, typename Row, typename Alloc, typename... Funcs>
+    class Group : public All<typename group_builder<Iterator, Row, Alloc, Funcs...>::container_type::iterator,
+                             group_proxy<Iterator, Row, Alloc, Funcs...>> {
+        using builder_t = group_builder<Iterator, Row, Alloc, Funcs...>;
+        using In = typename Iterator::value_type;
+    public:
+        using base_t = All<typename builder_t::container_type::iterator, group_proxy<Iterator, Row, Alloc, Funcs...>>;
+    public:
+        ~Group() = default;
+        Group() = delete;
+        Group(Group const &) = default;
+        Group(TState<Iterator> const &source, Alloc const &alloc, Funcs const &...keys)
+                : Group(builder_t(source, alloc, keys...))
+        {}
+        Group(TState<Iterator> const &source, Alloc const &alloc, thread_pool &pool, std::size_t const threads,
+              Funcs const &...keys)
+                : Group(builder_t(source, alloc, keys...).parallel(pool, threads))
+        {}
+
+        // GroupBy(keys...).Aggregate(seed, fold): the same key maps, holding fold results instead of rows
+        template<typename Seed, typename Fold>
+        constexpr auto aggregate(Seed const &seed, Fold const &fold) const noexcept(true) {
+            using acc_t = typename std::decay<Seed>::type;
+            using map_out = typename group_by<acc_t, Alloc, In, Funcs...>::type;
+            auto const builder = [source = builder_, seed = acc_t(seed), fold](map_out &out) {
+                source.aggregate(out, seed, fold);
+            };
+            return make_all<map_out>(builder, builder_.template map<map_out>());
+        }
+
+    private:
+        Group(builder_t const &builder)
+                : base_t(std::make_shared<typename group_proxy<Iterator, Row, Alloc, Funcs...>::element_type>(builder, builder.container())),
+                  builder_(builder)
+        {}
+
+        builder_t builder_;
+    };
+}
+
+#endif // !GROUP_H_
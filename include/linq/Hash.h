@@ -0,0 +1,298 @@
+#ifndef HASH_H_
+# define HASH_H_
+
+namespace linq
+{
+    // murmur3 finalizer: spreads clustered keys (ids, small ints) over every bit of the word
+    constexpr std::uint64_t mix(std::uint64_t x) noexcept(true) {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return x;
+    }
+
+    template<typename Key, typename = void>
+    struct hasher
+    {
+        std::size_t operator()(Key const &key) const noexcept(true) {
+            return static_cast<std::size_t>(mix(std::hash<Key>{}(key)));
+        }
+    };
+    // integers are left as they are: the tables spread them with a fibonacci multiply
+    template<typename Key>
+    struct hasher<Key, typename std::enable_if<std::is_integral<Key>::value || std::is_enum<Key>::value>::type>
+    {
+        constexpr std::size_t operator()(Key const &key) const noexcept(true) {
+            return static_cast<std::size_t>(key);
+        }
+    };
+
+    // a key path (the keys of a multi-level GroupBy) hashes as the mix of its parts
+    template<typename... Keys>
+    struct hasher<std::tuple<Keys...>, void>
+    {
+        std::size_t operator()(std::tuple<Keys...> const &path) const noexcept(true) {
+            return combine(path, std::index_sequence_for<Keys...>{});
+        }
+
+    private:
+        template<std::size_t... I>
+        static std::size_t combine(std::tuple<Keys...> const &path, std::index_sequence<I...>) noexcept(true) {
+            std::uint64_t hash = 0;
+            (void) std::initializer_list<int>{(hash = mix(hash ^ hasher<Keys>{}(std::get<I>(path))), 0)...};
+            return static_cast<std::size_t>(hash);
+        }
+    };
+
+    template<typename Key>
+    using is_hashable = std::is_default_constructible<std::hash<Key>>;
+    template<typename... Keys>
+    using is_hashable_path = std::is_same<std::integer_sequence<bool, true, is_hashable<Keys>::value...>,
+                                          std::integer_sequence<bool, is_hashable<Keys>::value..., true>>;
+
+    namespace detail
+    {
+        // the top bits of hash * 2^64/phi: one multiply that scatters sequential and
+        // clustered hashes over the whole table
+        constexpr std::size_t slot_of(std::size_t const hash, unsigned const shift) noexcept(true) {
+            return static_cast<std::size_t>((static_cast<std::uint64_t>(hash) * 0x9e3779b97f4a7c15ULL) >> shift);
+        }
+        inline unsigned slot_shift(std::size_t capacity) noexcept(true) {
+            unsigned shift = 64;
+            for (; capacity > 1; capacity >>= 1)
+                --shift;
+            return shift;
+        }
+    }
+
+    // open-addressing map with linear probing: the slot table only holds indices into a
+    // dense entry vector, so lookups touch one small array and iteration is a flat scan
+    // in insertion order
+    template<typename Key, typename Value, typename Hash = hasher<Key>, typename Alloc = default_allocator>
+    class flat_map
+    {
+        typedef std::uint32_t slot_type;
+    public:
+        typedef Key                                            key_type;
+        typedef Value                                          mapped_type;
+        typedef std::pair<Key, Value>                          value_type;
+        typedef rebind_alloc_t<Alloc, value_type>              allocator_type;
+        typedef std::vector<value_type, allocator_type>        entries_type;
+        typedef typename entries_type::iterator                iterator;
+        typedef typename entries_type::const_iterator          const_iterator;
+        typedef std::reverse_iterator<iterator>                reverse_iterator;
+        typedef std::reverse_iterator<const_iterator>          const_reverse_iterator;
+
+        flat_map() = default;
+        explicit flat_map(allocator_type const &alloc)
+                : entries_(alloc), slots_(alloc) {}
+
+        allocator_type get_allocator() const noexcept(true) { return entries_.get_allocator(); }
+
+        iterator begin() noexcept(true) { return entries_.begin(); }
+        iterator end() noexcept(true) { return entries_.end(); }
+        const_iterator begin() const noexcept(true) { return entries_.begin(); }
+        const_iterator end() const noexcept(true) { return entries_.end(); }
+        reverse_iterator rbegin() noexcept(true) { return entries_.rbegin(); }
+        reverse_iterator rend() noexcept(true) { return entries_.rend(); }
+        const_reverse_iterator rbegin() const noexcept(true) { return entries_.rbegin(); }
+        const_reverse_iterator rend() const noexcept(true) { return entries_.rend(); }
+
+        std::size_t size() const noexcept(true) { return entries_.size(); }
+        bool empty() const noexcept(true) { return entries_.empty(); }
+
+        void reserve(std::size_t const size) {
+            entries_.reserve(size);
+            if (size * 2 > slots_.size())
+                rehash(size * 2);
+        }
+
+        Value &operator[](Key const &key) {
+            if ((entries_.size() + 1) * 2 > slots_.size())
+                rehash(slots_.size() ? slots_.size() * 2 : 16);
+            auto &slot = slots_[probe(key)];
+            if (!slot) {
+                entries_.emplace_back(key, Value());
+                slot = static_cast<slot_type>(entries_.size());
+            }
+            return entries_[slot - 1].second;
+        }
+
+        std::pair<iterator, bool> emplace(Key const &key, Value value) {
+            if ((entries_.size() + 1) * 2 > slots_.size())
+                rehash(slots_.size() ? slots_.size() * 2 : 16);
+            auto &slot = slots_[probe(key)];
+            auto const inserted = !slot;
+            if (inserted) {
+                entries_.emplace_back(key, std::move(value));
+                slot = static_cast<slot_type>(entries_.size());
+            }
+            return std::make_pair(begin() + (slot - 1), inserted);
+        }
+
+        iterator find(Key const &key) noexcept(true) {
+            auto const slot = slots_.empty() ? 0 : slots_[probe(key)];
+            return slot ? begin() + (slot - 1) : end();
+        }
+        const_iterator find(Key const &key) const noexcept(true) {
+            auto const slot = slots_.empty() ? 0 : slots_[probe(key)];
+            return slot ? begin() + (slot - 1) : end();
+        }
+
+        Value &at(Key const &key) {
+            auto const it = find(key);
+            if (it == end())
+                throw std::out_of_range("flat_map::at");
+            return it->second;
+        }
+        Value const &at(Key const &key) const {
+            auto const it = find(key);
+            if (it == end())
+                throw std::out_of_range("flat_map::at");
+            return it->second;
+        }
+
+    private:
+        std::size_t probe(Key const &key) const noexcept(true) {
+            auto const mask = slots_.size() - 1;
+            auto pos = detail::slot_of(hash_(key), shift_);
+            while (slots_[pos] && !(entries_[slots_[pos] - 1].first == key))
+                pos = (pos + 1) & mask;
+            return pos;
+        }
+
+        void rehash(std::size_t size) {
+            std::size_t capacity = 16;
+            while (capacity < size)
+                capacity <<= 1;
+            slots_.assign(capacity, 0);
+            shift_ = detail::slot_shift(capacity);
+            for (std::size_t i = 0; i < entries_.size(); ++i) {
+                auto pos = detail::slot_of(hash_(entries_[i].first), shift_);
+                while (slots_[pos])
+                    pos = (pos + 1) & (capacity - 1);
+                slots_[pos] = static_cast<slot_type>(i + 1);
+            }
+        }
+
+        entries_type entries_;
+        std::vector<slot_type, rebind_alloc_t<Alloc, slot_type>> slots_;
+        Hash hash_;
+        unsigned shift_ = 64;
+    };
+
+    // the key-only counterpart of flat_map, with the same slot table over a dense key vector
+    template<typename Key, typename Hash = hasher<Key>, typename Alloc = default_allocator>
+    class flat_set
+    {
+        typedef std::uint32_t slot_type;
+    public:
+        typedef Key                                            key_type;
+        typedef Key                                            value_type;
+        typedef rebind_alloc_t<Alloc, value_type>              allocator_type;
+        typedef std::vector<value_type, allocator_type>        entries_type;
+        typedef typename entries_type::const_iterator          iterator;
+        typedef typename entries_type::const_iterator          const_iterator;
+
+        flat_set() = default;
+        explicit flat_set(allocator_type const &alloc)
+                : entries_(alloc), slots_(alloc) {}
+
+        allocator_type get_allocator() const noexcept(true) { return entries_.get_allocator(); }
+
+        const_iterator begin() const noexcept(true) { return entries_.begin(); }
+        const_iterator end() const noexcept(true) { return entries_.end(); }
+
+        std::size_t size() const noexcept(true) { return entries_.size(); }
+        bool empty() const noexcept(true) { return entries_.empty(); }
+
+        void reserve(std::size_t const size) {
+            entries_.reserve(size);
+            if (size * 2 > slots_.size())
+                rehash(size * 2);
+        }
+
+        std::pair<const_iterator, bool> insert(Key const &key) {
+            if ((entries_.size() + 1) * 2 > slots_.size())
+                rehash(slots_.size() ? slots_.size() * 2 : 16);
+            auto &slot = slots_[probe(key)];
+            auto const inserted = !slot;
+            if (inserted) {
+                entries_.push_back(key);
+                slot = static_cast<slot_type>(entries_.size());
+            }
+            return std::make_pair(begin() + (slot - 1), inserted);
+        }
+
+        const_iterator find(Key const &key) const noexcept(true) {
+            auto const slot = slots_.empty() ? 0 : slots_[probe(key)];
+            return slot ? begin() + (slot - 1) : end();
+        }
+        std::size_t count(Key const &key) const noexcept(true) { return find(key) != end(); }
+
+    private:
+        std::size_t probe(Key const &key) const noexcept(true) {
+            auto const mask = slots_.size() - 1;
+            auto pos = detail::slot_of(hash_(key), shift_);
+            while (slots_[pos] && !(entries_[slots_[pos] - 1] == key))
+                pos = (pos + 1) & mask;
+            return pos;
+        }
+
+        void rehash(std::size_t size) {
+            std::size_t capacity = 16;
+            while (capacity < size)
+                capacity <<= 1;
+            slots_.assign(capacity, 0);
+            shift_ = detail::slot_shift(capacity);
+            for (std::size_t i = 0; i < entries_.size(); ++i) {
+                auto pos = detail::slot_of(hash_(entries_[i]), shift_);
+                while (slots_[pos])
+                    pos = (pos + 1) & (capacity - 1);
+                slots_[pos] = static_cast<slot_type>(i + 1);
+            }
+        }
+
+        entries_type entries_;
+        std::vector<slot_type, rebind_alloc_t<Alloc, slot_type>> slots_;
+        Hash hash_;
+        unsigned shift_ = 64;
+    };
+
+    // flat tables for hashable keys, ordered trees for the rest
+    template<typename Key, typename Value, typename Alloc, bool hashable = is_hashable<Key>::value>
+    struct map_type
+    {
+        typedef flat_map<Key, Value, hasher<Key>, Alloc> type;
+    };
+    template<typename Key, typename Value, typename Alloc>
+    struct map_type<Key, Value, Alloc, false>
+    {
+        typedef std::map<Key, Value, std::less<Key>, rebind_alloc_t<Alloc, std::pair<Key const, Value>>> type;
+    };
+    template<typename Key, typename Alloc, bool hashable = is_hashable<Key>::value>
+    struct set_type
+    {
+        typedef flat_set<Key, hasher<Key>, Alloc> type;
+    };
+    template<typename Key, typename Alloc>
+    struct set_type<Key, Alloc, false>
+    {
+        typedef std::set<Key, std::less<Key>, rebind_alloc_t<Alloc, Key>> type;
+    };
+
+    namespace detail
+    {
+        template<typename Table>
+        auto reserve(Table &table, std::size_t const size, int) -> decltype(table.reserve(size)) { table.reserve(size); }
+        template<typename Table>
+        void reserve(Table &, std::size_t, long) {}
+    }
+    // trees have nothing to reserve
+    template<typename Table>
+    void reserve_table(Table &table, std::size_t const size) { detail::reserve(table, size, 0); }
+}
+
+#endif // !HASH_H_
@@ -0,0 +1,288 @@
+#ifndef JOIN_H_
+# define JOIN_H_
+
+namespace linq
+{
+    // the hashed side of a Join/GroupJoin, built on first enumeration: the inner rows grouped
+    // by key and probed by each outer row, or, when the outer side is known to be the smaller
+    // one, the outer keys hashed and the inner side streamed once into per-outer-row matches.
+    // Either way the matches of an outer row are a slice of inner row pointers
+    template<typename OuterIt, typename Inner, typename OuterKey, typename InnerKey, typename Result>
+    class join_state
+    {
+        using OuterIn = typename OuterIt::value_type;
+        using InnerIt = typename std::decay<decltype(std::declval<Inner const &>().begin())>::type;
+        using InnerIn = typename InnerIt::value_type;
+        using Key = typename std::decay<decltype(std::declval<InnerKey const &>()(std::declval<InnerIn>()))>::type;
+        using stable = std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<InnerIt>::iterator_category>;
+    public:
+        typedef group_row_t<InnerIn, !stable::value> row_type;
+        typedef group_range<row_type> range_type;
+
+        join_state(TState<OuterIt> const &outer, Inner const &inner,
+                   OuterKey const &outerKey, InnerKey const &innerKey, Result const &result)
+                : outer_(outer), inner_(inner), outerKey_(outerKey), innerKey_(innerKey), result_(result),
+                  index_(default_allocator()) {}
+
+        void build() const {
+            std::call_once(built_, [this] {
+                auto const outer = size_range(outer_.begin(), outer_.end());
+                auto const inner = size_range(inner_.begin(), inner_.end());
+                by_outer_ = outer.exact && inner.exact && outer.size < inner.size;
+                if (by_outer_)
+                    build_by_outer(outer.size);
+                else
+                    index_.build(inner_.begin(), inner_.end(), innerKey_);
+            });
+        }
+
+        template<typename In>
+        range_type matches(std::size_t const ordinal, In const &outer) const {
+            if (by_outer_)
+                return range_type(rows_.data(), starts_[ordinal], starts_[ordinal + 1] - starts_[ordinal]);
+            auto const found = index_.find(outerKey_(outer));
+            return found ? *found : range_type(nullptr, 0, 0);
+        }
+
+        template<typename Lhs, typename Rhs>
+        constexpr decltype(auto) result(Lhs &&outer, Rhs &&inner) const {
+            return result_(std::forward<Lhs>(outer), std::forward<Rhs>(inner));
+        }
+
+    private:
+        void build_by_outer(std::size_t const size) const {
+            // outer rows sharing a key are chained through next
+            constexpr std::size_t none = std::numeric_limits<std::size_t>::max();
+            typename map_type<Key, std::size_t, default_allocator>::type heads;
+            reserve_table(heads, size);
+            std::vector<std::size_t> next(size, none);
+            std::size_t ordinal = 0;
+            push_range(outer_.begin(), outer_.end(), [this, &heads, &next, &ordinal](OuterIn val) {
+                auto const slot = heads.emplace(outerKey_(val), ordinal);
+                if (!slot.second) {
+                    next[ordinal] = slot.first->second;
+                    slot.first->second = ordinal;
+                }
+                ++ordinal;
+                return true;
+            });
+
+            std::vector<std::size_t> counts(size, 0);
+            std::vector<std::pair<std::size_t, row_type>> staged;
+            push_range(inner_.begin(), inner_.end(), [this, &heads, &next, &counts, &staged](InnerIn val) {
+                auto const it = heads.find(innerKey_(val));
+                if (it == heads.end())
+                    return true;
+                for (auto id = it->second; id != none; id = next[id]) {
+                    ++counts[id];
+                    staged.emplace_back(id, row_traits<row_type>::make(val));
+                }
+                return true;
+            });
+
+            // counting scatter by outer ordinal, inner order kept within each outer row
+            starts_.assign(size + 1, 0);
+            for (std::size_t id = 0; id < size; ++id)
+                starts_[id + 1] = starts_[id] + counts[id];
+            std::vector<std::size_t> order(staged.size(), 0);
+            {
+                auto cursor = starts_;
+                for (std::size_t i = 0; i < staged.size(); ++i)
+                    order[cursor[staged[i].first]++] = i;
+            }
+            rows_.reserve(staged.size());
+            for (auto const i : order)
+                rows_.push_back(std::move(staged[i].second));
+        }
+
+        TState<OuterIt> const outer_;
+        Inner const inner_;
+        OuterKey const outerKey_;
+        InnerKey const innerKey_;
+        Result const result_;
+
+        mutable std::once_flag built_;
+        mutable bool by_outer_ = false;
+        mutable grouping<group_by<range_type, default_allocator, InnerIn, InnerKey>> index_;
+        mutable std::vector<row_type> rows_;
+        mutable std::vector<std::size_t> starts_;
+    };
+
+    // one output per (outer row, matching inner row); the outer side advances lazily
+    template<typename Base, typename State>
+    class join_it : public Base {
+        using row_it_t = typename State::range_type::iterator;
+    public:
+        typedef Base base;
+        typedef min_category_t<typename Base::iterator_category,
+                               std::forward_iterator_tag>        iterator_category;
+        typedef decltype(std::declval<State const &>().result(*std::declval<Base>(), *std::declval<row_it_t>())) value_type;
+        typedef typename Base::difference_type                    difference_type;
+        typedef typename Base::pointer                            pointer;
+        typedef value_type                                         reference;
+
+        join_it() = delete;
+        join_it(join_it const &) = default;
+        join_it(Base const &base, Base const &end, std::shared_ptr<State const> const &state) noexcept(true)
+                : Base(base), end_(end), state_(state), ordinal_(0), cur_(nullptr), last_(nullptr) {}
+
+        constexpr auto const &operator=(join_it const &rhs) noexcept(true) {
+            static_cast<Base &>(*this) = static_cast<Base const &>(rhs);
+            end_ = rhs.end_;
+            state_ = rhs.state_;
+            ordinal_ = rhs.ordinal_;
+            cur_ = rhs.cur_;
+            last_ = rhs.last_;
+            return *this;
+        }
+        constexpr auto const &operator++() noexcept(nothrow_range<Base>::value) {
+            if (++cur_ == last_) {
+                static_cast<Base &>(*this).operator++();
+                ++ordinal_;
+                seek();
+            }
+            return *this;
+        }
+        constexpr auto operator++(int) noexcept(nothrow_range<Base>::value)
+        {
+            auto tmp = *this;
+            operator++();
+            return (tmp);
+        }
+        constexpr value_type operator*() const noexcept(nothrow_range<Base>::value) {
+            return state_->result(*static_cast<Base const &>(*this), *cur_);
+        }
+        constexpr bool operator==(join_it const &rhs) const noexcept(nothrow_range<Base>::value) {
+            return static_cast<Base const &>(*this) == static_cast<Base const &>(rhs) && (exhausted() || cur_ == rhs.cur_);
+        }
+        constexpr bool operator!=(join_it const &rhs) const noexcept(nothrow_range<Base>::value) {
+            return !operator==(rhs);
+        }
+
+        // builds the hashed side, which enumerates the inner range
+        constexpr void settle() {
+            linq::settle(static_cast<Base &>(*this));
+            linq::settle(end_);
+            state_->build();
+            if (cur_ == last_)
+                seek();
+        }
+
+        constexpr State const &state() const noexcept(true) { return *state_; }
+        constexpr std::size_t ordinal() const noexcept(true) { return ordinal_; }
+        constexpr bool exhausted() const noexcept(true) { return static_cast<Base const &>(*this) == end_; }
+        // the matches of the current outer row left to visit
+        constexpr row_it_t current() const noexcept(true) { return cur_; }
+        constexpr row_it_t last() const noexcept(true) { return last_; }
+
+    private:
+        constexpr void seek() noexcept(nothrow_range<Base>::value) {
+            for (; !exhausted(); static_cast<Base &>(*this).operator++(), ++ordinal_) {
+                auto const range = state_->matches(ordinal_, *static_cast<Base const &>(*this));
+                if (!range.empty()) {
+                    cur_ = range.begin();
+                    last_ = range.end();
+                    return;
+                }
+            }
+            cur_ = last_ = row_it_t(nullptr);
+        }
+
+        Base end_;
+        std::shared_ptr<State const> state_;
+        std::size_t ordinal_;
+        row_it_t cur_;
+        row_it_t last_;
+    };
+
+    // one output per outer row, with the slice of its matches (possibly empty)
+    template<typename Base, typename State>
+    class group_join_it : public Base {
+    public:
+        typedef Base base;
+        typedef min_category_t<typename Base::iterator_category,
+                               std::forward_iterator_tag>        iterator_category;
+        typedef decltype(std::declval<State const &>().result(*std::declval<Base>(),
+                                                              std::declval<typename State::range_type>())) value_type;
+        typedef typename Base::difference_type                    difference_type;
+        typedef typename Base::pointer                            pointer;
+        typedef value_type                                         reference;
+
+        group_join_it() = delete;
+        group_join_it(group_join_it const &) = default;
+        group_join_it(Base const &base, std::shared_ptr<State const> const &state) noexcept(true)
+                : Base(base), state_(state), ordinal_(0) {}
+
+        constexpr auto const &operator=(group_join_it const &rhs) noexcept(true) {
+            static_cast<Base &>(*this) = static_cast<Base const &>(rhs);
+            state_ = rhs.state_;
+            ordinal_ = rhs.ordinal_;
+            return *this;
+        }
+        constexpr auto const &operator++() noexcept(nothrow_range<Base>::value) {
+            static_cast<Base &>(*this).operator++();
+            ++ordinal_;
+            return *this;
+        }
+        constexpr auto operator++(int) noexcept(nothrow_range<Base>::value)
+        {
+            auto tmp = *this;
+            operator++();
+            return (tmp);
+        }
+        constexpr value_type operator*() const noexcept(nothrow_range<Base>::value) {
+            decltype(auto) outer = *static_cast<Base const &>(*this);
+            return state_->result(outer, state_->matches(ordinal_, outer));
+        }
+
+        constexpr void settle() {
+            linq::settle(static_cast<Base &>(*this));
+            state_->build();
+        }
+
+        constexpr State const &state() const noexcept(true) { return *state_; }
+        constexpr std::size_t ordinal() const noexcept(true) { return ordinal_; }
+
+    private:
+        std::shared_ptr<State const> state_;
+        std::size_t ordinal_;
+    };
+
+    template<typename OuterIt, typename State>
+    class Join : public TState<join_it<OuterIt, State>> {
+    public:
+        typedef join_it<OuterIt, State> iterator;
+        typedef iterator const_iterator;
+
+        using base_t = TState<iterator>;
+    public:
+        ~Join() = default;
+        Join() = delete;
+        Join(Join const &rhs)
+                : base_t(static_cast<base_t const &>(rhs))
+        {}
+        Join(OuterIt const &begin, OuterIt const &end, std::shared_ptr<State const> const &state) noexcept(true)
+                : base_t(iterator(begin, end, state), iterator(end, end, state), state)
+        {}
+    };
+
+    template<typename OuterIt, typename State>
+    class GroupJoin : public TState<group_join_it<OuterIt, State>> {
+    public:
+        typedef group_join_it<OuterIt, State> iterator;
+        typedef iterator const_iterator;
+
+        using base_t = TState<iterator>;
+    public:
+        ~GroupJoin() = default;
+        GroupJoin() = delete;
+        GroupJoin(GroupJoin const &rhs)
+                : base_t(static_cast<base_t const &>(rhs))
+        {}
+        GroupJoin(OuterIt const &begin, OuterIt const &end, std::shared_ptr<State const> const &state) noexcept(true)
+                : base_t(iterator(begin, state), iterator(end, state), state)
+        {}
+    };
+}
+
+#endif // !JOIN_H_
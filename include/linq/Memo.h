@@ -0,0 +1,204 @@
+#ifndef MEMO_H_
+# define MEMO_H_
+
+namespace linq
+{
+    // the rows of a memoized query, computed once and only as far as a consumer read. They
+    // live in geometrically growing segments that never move, so readers index the filled
+    // prefix without locking while one writer at a time pulls the next rows from upstream
+    template<typename BaseIt>
+    class memo_state
+    {
+    public:
+        typedef typename std::decay<decltype(*std::declval<BaseIt>())>::type value_type;
+        // whether computing rows can throw: the upstream may, and so may copying its rows
+        typedef std::integral_constant<bool, nothrow_range<BaseIt>::value
+                                             && std::is_nothrow_constructible<value_type, decltype(*std::declval<BaseIt>())>::value> nothrow;
+
+        memo_state(BaseIt const &begin, BaseIt const &end, stage_context const &upstream)
+                : cursor_(begin), end_(end), upstream_(upstream) {}
+        memo_state(memo_state const &) = delete;
+        ~memo_state() {
+            auto const size = size_.load(std::memory_order_relaxed);
+            for (std::size_t index = 0; index < size; ++index)
+                at(index).~value_type();
+        }
+
+        // whether row index exists, computing the rows up to it (and up to ahead more) on the
+        // first request
+        bool fetch(std::size_t const index, std::size_t const ahead = 0) const noexcept(nothrow::value) {
+            return index < size_.load(std::memory_order_acquire) || fill(index, ahead);
+        }
+        value_type const &at(std::size_t const index) const noexcept(true) {
+            auto const segment = segment_of(index);
+            return *reinterpret_cast<value_type const *>(&segments_[segment][index - first_of(segment)]);
+        }
+        // the filled rows from index up to the end of its segment
+        std::pair<value_type const *, std::size_t> span(std::size_t const index) const noexcept(true) {
+            auto const size = size_.load(std::memory_order_acquire);
+            if (index >= size)
+                return {nullptr, 0};
+            auto const segment = segment_of(index);
+            auto const last = std::min(size, first_of(segment + 1));
+            return {&at(index), last - index};
+        }
+
+        size_hint hint() const {
+            std::lock_guard<std::mutex> lock(lock_);
+            settle();
+            auto const size = size_.load(std::memory_order_relaxed);
+            if (done_)
+                return size_hint{size, true};
+            auto const rest = size_range(cursor_, end_);
+            return size_hint{rest.size == unknown_size ? unknown_size : size + rest.size, rest.exact};
+        }
+
+    private:
+        typedef typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type slot_t;
+        static constexpr std::size_t first_shift = 6;
+
+        // segment k holds 64 << k rows
+        static constexpr std::size_t segment_of(std::size_t const index) noexcept(true) {
+            std::size_t segment = 0;
+            for (auto q = (index >> first_shift) + 1; q > 1; q >>= 1)
+                ++segment;
+            return segment;
+        }
+        static constexpr std::size_t first_of(std::size_t const segment) noexcept(true) {
+            return ((std::size_t(1) << segment) - 1) << first_shift;
+        }
+
+        void settle() const noexcept(nothrow::value) {
+            if (!settled_) {
+                linq::settle(cursor_);
+                linq::settle(end_);
+                settled_ = true;
+            }
+        }
+
+        bool fill(std::size_t const index, std::size_t const ahead) const noexcept(nothrow::value) {
+            std::lock_guard<std::mutex> lock(lock_);
+            settle();
+            auto size = size_.load(std::memory_order_relaxed);
+            for (auto const last = index + ahead; size <= last && !done_; ++cursor_) {
+                if (cursor_ == end_) {
+                    done_ = true;
+                    break;
+                }
+                auto const segment = segment_of(size);
+                if (!segments_[segment])
+                    segments_[segment].reset(new slot_t[first_of(segment + 1) - first_of(segment)]);
+                new (&segments_[segment][size - first_of(segment)]) value_type(*cursor_);
+                size_.store(++size, std::memory_order_release);
+            }
+            return index < size;
+        }
+
+        mutable BaseIt cursor_;
+        mutable BaseIt end_;
+        stage_context const upstream_;
+
+        mutable std::mutex lock_;
+        mutable bool settled_ = false;
+        mutable bool done_ = false;
+        mutable std::atomic<std::size_t> size_{0};
+        mutable std::array<std::unique_ptr<slot_t[]>, 64 - first_shift> segments_;
+    };
+
+    // a position in the memo; the end iterator is the npos index and compares equal to any
+    // position past the last row. Reading and comparing may compute rows, and throw what
+    // the upstream throws
+    template<typename State>
+    class memo_it
+    {
+    public:
+        typedef std::forward_iterator_tag                        iterator_category;
+        typedef typename State::value_type const                 &value_type;
+        typedef std::ptrdiff_t                                   difference_type;
+        typedef typename State::value_type const                 *pointer;
+        typedef value_type                                       reference;
+
+        static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+        memo_it() = delete;
+        memo_it(std::shared_ptr<State const> const &state, std::size_t const index) noexcept(true)
+                : state_(state), index_(index) {}
+
+        constexpr value_type operator*() const noexcept(State::nothrow::value) {
+            state_->fetch(index_);
+            return state_->at(index_);
+        }
+        constexpr pointer operator->() const noexcept(State::nothrow::value) { return &operator*(); }
+
+        constexpr auto const &operator++() noexcept(true) {
+            ++index_;
+            return (*this);
+        }
+        constexpr auto operator++(int) noexcept(true) {
+            auto tmp = *this;
+            ++index_;
+            return (tmp);
+        }
+
+        constexpr bool operator==(memo_it const &rhs) const noexcept(State::nothrow::value) {
+            if (index_ == rhs.index_)
+                return true;
+            if (rhs.index_ == npos)
+                return !state_->fetch(index_);
+            return index_ == npos && !state_->fetch(rhs.index_);
+        }
+        constexpr bool operator!=(memo_it const &rhs) const noexcept(State::nothrow::value) { return !operator==(rhs); }
+
+        constexpr void settle() noexcept(true) {}
+
+        constexpr State const &state() const noexcept(true) { return *state_; }
+        constexpr std::size_t index() const noexcept(true) { return index_; }
+
+    private:
+        std::shared_ptr<State const> state_;
+        std::size_t index_;
+    };
+
+    template<typename BaseIt>
+    class Memoize : public TState<memo_it<memo_state<BaseIt>>> {
+        using state_t = memo_state<BaseIt>;
+    public:
+        typedef memo_it<state_t> iterator;
+        typedef iterator const_iterator;
+
+        using base_t = TState<iterator>;
+        using Out = typename iterator::value_type;
+    public:
+        ~Memoize() = default;
+        Memoize() = delete;
+        Memoize(Memoize const &rhs)
+                : base_t(static_cast<base_t const &>(rhs))
+        {}
+        Memoize(BaseIt const &begin, BaseIt const &end, stage_context const &upstream)
+                : Memoize(std::make_shared<state_t const>(begin, end, upstream))
+        {}
+
+        // forward only: the last row is found once the memo is complete, Reverse copies it
+        constexpr Out last() const noexcept(state_t::nothrow::value) {
+            auto const &state = this->begin().state();
+            std::size_t index = 0;
+            while (state.fetch(index + 1))
+                ++index;
+            return state.at(index);
+        }
+        constexpr auto lastOrDefault() const noexcept(state_t::nothrow::value) {
+            return this->any() ? last() : typename std::remove_reference<Out>::type{};
+        }
+        constexpr auto reverse() const noexcept(true) { return this->all().reverse(); }
+
+    private:
+        explicit Memoize(std::shared_ptr<state_t const> const &state) noexcept(true)
+                : base_t(iterator(state, 0), iterator(state, iterator::npos), state)
+        {
+            // nothing to settle, consumers on other threads may share the handle right away
+            this->settle();
+        }
+    };
+}
+
+#endif // !MEMO_H_
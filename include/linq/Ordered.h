@@ -0,0 +1,110 @@
+#ifndef ORDERED_H_
+# define ORDERED_H_
+
+namespace linq
+{
+    // builds the OrderBy result: the whole source sorted, or only its first `limit` rows,
+    // as copies or (by_ref) as references to the source rows; after AsParallel the full
+    // sort runs on the pool
+    template<typename Iterator, typename Row, typename Alloc, typename... Filters>
+    class order_builder
+    {
+    public:
+        typedef Row value_type;
+        typedef std::vector<value_type, rebind_alloc_t<Alloc, value_type>> container_type;
+
+        static constexpr std::size_t all = std::numeric_limits<std::size_t>::max();
+
+        order_builder(TState<Iterator> const &source, Alloc const &alloc, std::size_t const limit, Filters const &...filters)
+                : source_(source), alloc_(alloc), limit_(limit), filters_(filters...) {}
+
+        container_type container() const { return container_type(alloc_); }
+
+        void operator()(container_type &out) const {
+            run(out, std::index_sequence_for<Filters...>{});
+        }
+
+        constexpr order_builder limit(std::size_t const limit) const noexcept(true) {
+            auto ret = *this;
+            ret.limit_ = limit;
+            return ret;
+        }
+        constexpr order_builder parallel(thread_pool &pool, std::size_t const threads) const noexcept(true) {
+            auto ret = *this;
+            ret.pool_ = &pool;
+            ret.threads_ = threads;
+            return ret;
+        }
+
+    private:
+        template<std::size_t... I>
+        void run(container_type &out, std::index_sequence<I...>) const {
+            if (limit_ != all) {
+                top_by(source_.begin(), source_.end(), limit_, out, std::get<I>(filters_)...);
+                return;
+            }
+            collect(source_.begin(), source_.end(), out);
+            if (pool_)
+                parallel_sort_by(out, *pool_, threads_, std::get<I>(filters_)...);
+            else
+                sort_by(out, std::get<I>(filters_)...);
+        }
+
+        TState<Iterator> source_;
+        Alloc alloc_;
+        std::size_t limit_;
+        std::tuple<Filters...> filters_;
+        thread_pool *pool_ = nullptr;
+        std::size_t threads_ = 1;
+    };
+
+    template<typename Iterator, typename Row, typename Alloc, typename... Filters>
+    using ordered_proxy = std::shared_ptr<deferred<typename order_builder<Iterator, Row, Alloc, Filters...>::container_type,
+                                                   order_builder<Iterator, Row, Alloc, Filters...>>>;
+
+    template<typename Iterator, typename Row, typename Alloc, typename... Filters>
+    class Ordered : public All<stored_it_t<typename order_builder<Iterator, Row, Alloc, Filters...>::container_type>,
+                               ordered_proxy<Iterator, Row, Alloc, Filters...>> {
+        using builder_t = order_builder<Iterator, Row, Alloc, Filters...>;
+        using container_t = typename builder_t::container_type;
+        using proxy_t = ordered_proxy<Iterator, Row, Alloc, Filters...>;
+        using row_t = stored_it_t<container_t>;
+        using Out = typename std::iterator_traits<row_t>::reference;
+    public:
+        using base_t = All<row_t, proxy_t>;
+    public:
+        ~Ordered() = default;
+        Ordered() = delete;
+        Ordered(Ordered const &) = default;
+        Ordered(TState<Iterator> const &source, Alloc const &alloc, Filters const &...filters)
+                : Ordered(builder_t(source, alloc, builder_t::all, filters...))
+        {}
+        Ordered(TState<Iterator> const &source, Alloc const &alloc, thread_pool &pool, std::size_t const threads,
+                Filters const &...filters)
+                : Ordered(builder_t(source, alloc, builder_t::all, filters...).parallel(pool, threads))
+        {}
+
+        // bounded Take/First never sort more than they return
+        constexpr auto take(int const max) const noexcept(true) {
+            return base_t(make_proxy(builder_.limit(max > 0 ? static_cast<std::size_t>(max) : 0)));
+        }
+        constexpr Out first() const { return *bounds<row_t>::begin(head_->get()); }
+        constexpr auto firstOrDefault() const {
+            return head_->get().empty() ? typename std::decay<Out>::type{} : first();
+        }
+
+    private:
+        Ordered(builder_t const &builder)
+                : base_t(make_proxy(builder)), builder_(builder), head_(make_proxy(builder.limit(1)))
+        {}
+
+        static proxy_t make_proxy(builder_t const &builder) {
+            return std::make_shared<typename proxy_t::element_type>(builder, builder.container());
+        }
+
+        builder_t builder_;
+        proxy_t head_;
+    };
+}
+
+#endif // !ORDERED_H_
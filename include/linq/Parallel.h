@@ -0,0 +1,327 @@
+#ifndef PARALLEL_H_
+# define PARALLEL_H_
+
+namespace linq
+{
+    // cuts [begin, end) into the part-th of parts sub-ranges, random-access ranges by offset,
+    // filtered ones by slicing their base range and seeking the first match inside the slice
+    template<typename It>
+    struct splitter
+    {
+        static constexpr bool value = std::is_base_of<std::random_access_iterator_tag,
+                typename std::iterator_traits<It>::iterator_category>::value;
+
+        static std::pair<It, It> slice(It const &begin, It const &end, std::size_t const part, std::size_t const parts) noexcept(true)
+        {
+            using diff_t = typename std::iterator_traits<It>::difference_type;
+            auto const size = static_cast<std::size_t>(end - begin);
+            return std::pair<It, It>(begin + static_cast<diff_t>(size * part / parts),
+                                     begin + static_cast<diff_t>(size * (part + 1) / parts));
+        }
+    };
+    template<typename Base>
+    struct splitter<basic_it<Base>>
+    {
+        using it_t = basic_it<Base>;
+        static constexpr bool value = splitter<Base>::value;
+
+        static std::pair<it_t, it_t> slice(it_t const &begin, it_t const &end, std::size_t const part, std::size_t const parts) noexcept(true)
+        {
+            auto const range = splitter<Base>::slice(begin, end, part, parts);
+            return std::pair<it_t, it_t>(it_t(range.first), it_t(range.second));
+        }
+    };
+    template<typename Base, typename Seek>
+    struct splitter<seek_it<Base, Seek>>
+    {
+        using it_t = seek_it<Base, Seek>;
+        static constexpr bool value = splitter<Base>::value;
+
+        static std::pair<it_t, it_t> slice(it_t const &begin, it_t const &end, std::size_t const part, std::size_t const parts) noexcept(true)
+        {
+            auto const range = splitter<Base>::slice(begin, end, part, parts);
+            return std::pair<it_t, it_t>(it_t(range.first, begin.closure()), it_t(range.second, begin.closure()));
+        }
+    };
+    template<typename Base, typename Loader>
+    struct splitter<select_it<Base, Loader>>
+    {
+        using it_t = select_it<Base, Loader>;
+        static constexpr bool value = splitter<Base>::value;
+
+        static std::pair<it_t, it_t> slice(it_t const &begin, it_t const &end, std::size_t const part, std::size_t const parts) noexcept(true)
+        {
+            auto const range = splitter<Base>::slice(begin, end, part, parts);
+            return std::pair<it_t, it_t>(it_t(range.first, begin.closure()), it_t(range.second, begin.closure()));
+        }
+    };
+    template<typename Base, typename Proxy>
+    struct splitter<all_it<Base, Proxy>>
+    {
+        using it_t = all_it<Base, Proxy>;
+        static constexpr bool value = splitter<Base>::value;
+
+        static std::pair<it_t, it_t> slice(it_t const &begin, it_t const &end, std::size_t const part, std::size_t const parts) noexcept(true)
+        {
+            auto const range = splitter<Base>::slice(begin, end, part, parts);
+            return std::pair<it_t, it_t>(it_t(range.first, begin.proxy()), it_t(range.second, begin.proxy()));
+        }
+    };
+    template<typename Base, typename Filter>
+    struct splitter<where_it<Base, Filter>>
+    {
+        using it_t = where_it<Base, Filter>;
+        static constexpr bool value = splitter<Base>::value;
+
+        static std::pair<it_t, it_t> slice(it_t const &begin, it_t const &end, std::size_t const part, std::size_t const parts) noexcept(true)
+        {
+            auto const range = splitter<Base>::slice(begin, end, part, parts);
+            return std::pair<it_t, it_t>(
+                    it_t(std::find_if(range.first, range.second, begin.filter()), range.second, begin.closure()),
+                    it_t(range.second, range.second, begin.closure()));
+        }
+    };
+
+    template<typename Iterator>
+    class Parallel : public TState<Iterator>
+    {
+        using Out = typename Iterator::value_type;
+        using stable = std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<Iterator>::iterator_category>;
+        using value_t = typename std::remove_const<typename std::remove_reference<Out>::type>::type;
+        using splittable = std::integral_constant<bool, splitter<Iterator>::value>;
+
+    public:
+        typedef Iterator iterator;
+        typedef iterator const_iterator;
+
+        using base_t = TState<iterator>;
+    public:
+        ~Parallel() = default;
+        Parallel() = delete;
+        Parallel(Parallel const &) = default;
+        Parallel(Iterator const &begin, Iterator const &end, std::size_t const threads, thread_pool &pool,
+                 stage_context const &context = nullptr) noexcept(true)
+                : base_t(Iterator(begin), Iterator(end), context), threads_(threads ? threads : pool.size()), pool_(&pool)
+        {}
+
+        constexpr auto asSequential() const noexcept(true) {
+            return From<Iterator>(this->begin_, this->end_, this->context());
+        }
+
+        template<typename Func>
+        constexpr auto select(Func const &nextloader_) const noexcept(true) {
+            return parallel(base_t::select(nextloader_));
+        }
+        template<typename... Funcs>
+        constexpr auto selectMany(Funcs const &...loaders) const noexcept(true) {
+            return parallel(base_t::selectMany(loaders...));
+        }
+        template<typename Func>
+        constexpr auto where(Func const &nextfilter_) const noexcept(true) {
+            return parallel(base_t::where(nextfilter_));
+        }
+        constexpr auto skip(std::size_t const offset) const noexcept(true) {
+            return parallel(base_t::skip(offset));
+        }
+        constexpr auto take(int const max) const noexcept(true) {
+            return take(max, typename std::iterator_traits<Iterator>::iterator_category{});
+        }
+
+        // grouped on the pool, the stages after it run sequentially
+        template<typename Func, typename... Funcs, typename std::enable_if<!is_allocator<Func>::value, int>::type = 0>
+        constexpr auto groupBy(Func const &key, Funcs const &...keys) const {
+            return grouped<group_row_t<Out, !stable::value>>(default_allocator(), key, keys...);
+        }
+        template<typename... Funcs>
+        constexpr auto groupBy(by_copy_t, Funcs const &...keys) const {
+            return grouped<group_row_t<Out, true>>(default_allocator(), keys...);
+        }
+        template<typename Alloc, typename... Funcs, typename std::enable_if<is_allocator<Alloc>::value, int>::type = 0>
+        constexpr auto groupBy(Alloc const &alloc, Funcs const &...keys) const {
+            return grouped<group_row_t<Out, !stable::value>>(alloc, keys...);
+        }
+        template<typename Alloc, typename... Funcs, typename std::enable_if<is_allocator<Alloc>::value, int>::type = 0>
+        constexpr auto groupBy(Alloc const &alloc, by_copy_t, Funcs const &...keys) const {
+            return grouped<group_row_t<Out, true>>(alloc, keys...);
+        }
+        template<typename... Funcs>
+        constexpr auto groupBy(by_ref_t, Funcs const &...keys) const {
+            return grouped<group_row_t<Out, !stable::value>>(default_allocator(), keys...);
+        }
+        template<typename Alloc, typename... Funcs, typename std::enable_if<is_allocator<Alloc>::value, int>::type = 0>
+        constexpr auto groupBy(Alloc const &alloc, by_ref_t, Funcs const &...keys) const {
+            return grouped<group_row_t<Out, !stable::value>>(alloc, keys...);
+        }
+
+        // sorted on the pool, the stages after it run sequentially
+        template<typename Func, typename... Funcs, typename std::enable_if<!is_allocator<Func>::value, int>::type = 0>
+        constexpr auto orderBy(Func const &key, Funcs const &... keys) const noexcept(true) {
+            return ordered<stored_row_t<Out, false>>(default_allocator(), key, keys...);
+        }
+        template<typename... Funcs>
+        constexpr auto orderBy(by_ref_t, Funcs const &... keys) const noexcept(true) {
+            return ordered<stored_row_t<Out, stable::value>>(default_allocator(), keys...);
+        }
+        template<typename Alloc, typename... Funcs, typename std::enable_if<is_allocator<Alloc>::value, int>::type = 0>
+        constexpr auto orderBy(Alloc const &alloc, Funcs const &... keys) const noexcept(true) {
+            return ordered<stored_row_t<Out, false>>(alloc, keys...);
+        }
+        template<typename Alloc, typename... Funcs, typename std::enable_if<is_allocator<Alloc>::value, int>::type = 0>
+        constexpr auto orderBy(Alloc const &alloc, by_ref_t, Funcs const &... keys) const noexcept(true) {
+            return ordered<stored_row_t<Out, stable::value>>(alloc, keys...);
+        }
+
+        constexpr Out first() const noexcept(true) { return first(splittable{}); }
+        template<typename Func>
+        constexpr void each(Func const &pred) const noexcept(true) { each(pred, splittable{}); }
+        template<typename T>
+        constexpr bool contains(T const &elem) const noexcept(true) { return contains(elem, splittable{}); }
+        constexpr auto count() const noexcept(true) { return count(splittable{}); }
+        constexpr auto min() const noexcept(true) { return min(splittable{}); }
+        constexpr auto max() const noexcept(true) { return max(splittable{}); }
+        constexpr auto sum() const noexcept(true) { return sum(splittable{}); }
+
+    private:
+        // a counted take over a random-access range is a shorter range; otherwise its end is
+        // a sentinel the sequential Take handle knows how to walk back from
+        constexpr auto take(int const max, std::random_access_iterator_tag) const noexcept(true) {
+            return parallel(base_t::take(max));
+        }
+        constexpr auto take(int const max, std::input_iterator_tag) const noexcept(true) {
+            return base_t::take(max);
+        }
+
+        template<typename Handle>
+        constexpr auto parallel(Handle const &handle) const noexcept(true) {
+            using it_t = typename Handle::iterator;
+            auto const &state = static_cast<TState<it_t> const &>(handle);
+            return Parallel<it_t>(state.begin_, state.end_, threads_, *pool_, state.context());
+        }
+
+        template<typename Row, typename Alloc, typename... Funcs>
+        constexpr auto grouped(Alloc const &alloc, Funcs const &...keys) const {
+            return Group<Iterator, Row, Alloc, column_key_t<Iterator, Funcs>...>(*this, alloc, *pool_, threads_, bind_key(this->begin_, keys)...);
+        }
+        template<typename Row, typename Alloc, typename... Funcs>
+        constexpr auto ordered(Alloc const &alloc, Funcs const &...keys) const noexcept(true) {
+            return Ordered<Iterator, Row, Alloc, Funcs...>(*this, alloc, *pool_, threads_, keys...);
+        }
+
+        // a few parts per thread so the pool can even out unbalanced filters
+        std::size_t parts() const noexcept(true) { return threads_ * 4; }
+
+        // the bounds settle here, on the calling thread, before the workers share them. Parts
+        // that skip() rules out are not sliced, as slicing a filtered range already filters
+        template<typename Func, typename Skip>
+        void for_each_part(Func const &func, Skip const &skip) const noexcept(true) {
+            auto const parts = this->parts();
+            auto const &begin = this->begin();
+            auto const &end = this->end();
+            std::atomic<std::size_t> next(0);
+            pool_->run(threads_, [&](std::size_t) {
+                for (std::size_t part; (part = next++) < parts;)
+                {
+                    if (skip(part))
+                        continue;
+                    auto const range = splitter<Iterator>::slice(begin, end, part, parts);
+                    func(range.first, range.second, part);
+                }
+            });
+        }
+        template<typename Func>
+        void for_each_part(Func const &func) const noexcept(true) {
+            for_each_part(func, [](std::size_t) noexcept(true) { return false; });
+        }
+
+        Out first(std::false_type) const noexcept(true) { return base_t::first(); }
+        // no part holding a match: the range is empty, and First is what it is sequentially
+        Out first(std::true_type) const noexcept(true) {
+            std::vector<Iterator> hits(parts(), this->end());
+            std::atomic<std::size_t> best(parts());
+            for_each_part([&](Iterator const &it, Iterator const &end, std::size_t const part) {
+                if (it == end)
+                    return;
+                hits[part] = it;
+                auto current = best.load(std::memory_order_relaxed);
+                while (part < current && !best.compare_exchange_weak(current, part));
+            }, [&best](std::size_t const part) noexcept(true) { return part > best.load(std::memory_order_relaxed); });
+            auto const found = best.load();
+            return found < hits.size() ? *hits[found] : base_t::first();
+        }
+
+        template<typename Func>
+        void each(Func const &pred, std::false_type) const noexcept(true) { base_t::each(pred); }
+        template<typename Func>
+        void each(Func const &pred, std::true_type) const noexcept(true) {
+            for_each_part([&pred](Iterator const &it, Iterator const &end, std::size_t) {
+                push_range(it, end, [&pred](Out val) {
+                    pred(val);
+                    return true;
+                });
+            });
+        }
+
+        template<typename T>
+        bool contains(T const &elem, std::false_type) const noexcept(true) { return base_t::contains(elem); }
+        template<typename T>
+        bool contains(T const &elem, std::true_type) const noexcept(true) {
+            std::atomic<bool> found(false);
+            for_each_part([&](Iterator const &it, Iterator const &end, std::size_t) {
+                push_range(it, end, [&](Out val) {
+                    if (val == elem)
+                        found = true;
+                    return !found.load(std::memory_order_relaxed);
+                });
+            });
+            return found;
+        }
+
+        std::size_t count(std::false_type) const noexcept(true) { return base_t::count(); }
+        std::size_t count(std::true_type) const noexcept(true) {
+            std::vector<std::size_t> partial(parts());
+            for_each_part([&partial](Iterator const &it, Iterator const &end, std::size_t const part) {
+                partial[part] = count_range(it, end);
+            });
+            return std::accumulate(partial.begin(), partial.end(), std::size_t(0));
+        }
+
+        value_t min(std::false_type) const noexcept(true) { return base_t::min(); }
+        value_t min(std::true_type) const noexcept(true) {
+            return extremum(std::less<value_t>(), [](Iterator const &it, Iterator const &end) { return min_range(it, end); });
+        }
+        value_t max(std::false_type) const noexcept(true) { return base_t::max(); }
+        value_t max(std::true_type) const noexcept(true) {
+            return extremum(std::greater<value_t>(), [](Iterator const &it, Iterator const &end) { return max_range(it, end); });
+        }
+        template<typename Compare, typename Reduce>
+        value_t extremum(Compare const &cmp, Reduce const &reduce) const noexcept(true) {
+            std::vector<std::pair<bool, value_t>> partial(parts());
+            for_each_part([&](Iterator const &it, Iterator const &end, std::size_t const part) {
+                if (it != end)
+                    partial[part] = std::make_pair(true, reduce(it, end));
+            });
+            std::pair<bool, value_t> result(false, value_t{});
+            for (auto const &it : partial)
+                if (it.first && (!result.first || cmp(it.second, result.second)))
+                    result = it;
+            return result.second;
+        }
+
+        value_t sum(std::false_type) const noexcept(true) { return base_t::sum(); }
+        value_t sum(std::true_type) const noexcept(true) {
+            std::vector<value_t> partial(parts());
+            for_each_part([&partial](Iterator const &it, Iterator const &end, std::size_t const part) {
+                partial[part] = sum_range(it, end);
+            });
+            value_t result{};
+            for (auto const &it : partial)
+                result += it;
+            return result;
+        }
+
+        std::size_t threads_;
+        thread_pool *pool_;
+    };
+}
+
+#endif // !PARALLEL_H_
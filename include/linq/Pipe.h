@@ -0,0 +1,246 @@
+#ifndef PIPE_H_
+# define PIPE_H_
+
+namespace linq
+{
+    // bounded single-producer/single-consumer ring between the thread running the upstream
+    // of Prefetch and the one enumerating it. Slots are claimed and released through the
+    // head/tail counters alone; a side finding the ring full (or empty) spins for a while,
+    // then sleeps until the other side moves. Rows that are references to the source travel
+    // as pointers, temporaries (and the rows of single-pass ranges, which live in the
+    // iterator) are moved into the slots. An exception thrown upstream ends the rows and is
+    // rethrown on the consumer
+    template<typename BaseIt>
+    class pipe_state
+    {
+        using stable = std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<BaseIt>::iterator_category>;
+    public:
+        typedef stored_row_t<decltype(*std::declval<BaseIt>()), stable::value> row_type;
+
+        pipe_state(BaseIt const &begin, BaseIt const &end, std::size_t const capacity)
+                : begin_(begin), end_(end), mask_(round_up(capacity) - 1), slots_(new slot_t[mask_ + 1]) {
+            producer_ = std::thread([this]() { produce(); });
+        }
+        pipe_state(pipe_state const &) = delete;
+        // stops the producer if the consumer left early
+        ~pipe_state() {
+            stop_.store(true);
+            wake();
+            producer_.join();
+            for (auto head = head_.load(std::memory_order_relaxed); head != tail_.load(std::memory_order_relaxed); ++head)
+                at(head).~row_type();
+        }
+
+        // the next row, nullptr once the upstream is exhausted
+        row_type *peek() {
+            auto const head = head_.load(std::memory_order_relaxed);
+            wait([this, head]() { return tail_.load() != head || done_.load(); });
+            if (tail_.load() != head)
+                return &at(head);
+            if (error_)
+                std::rethrow_exception(error_);
+            return nullptr;
+        }
+        void pop() {
+            auto const head = head_.load(std::memory_order_relaxed);
+            at(head).~row_type();
+            head_.store(head + 1);
+            if (sleepers_.load())
+                wake();
+        }
+
+    private:
+        typedef typename std::aligned_storage<sizeof(row_type), alignof(row_type)>::type slot_t;
+        static constexpr int spins = 256;
+
+        static std::size_t round_up(std::size_t const capacity) noexcept(true) {
+            std::size_t size = 2;
+            while (size < capacity)
+                size <<= 1;
+            return size;
+        }
+        row_type &at(std::size_t const index) const noexcept(true) {
+            return *reinterpret_cast<row_type *>(&slots_[index & mask_]);
+        }
+
+        void produce() {
+            try {
+                push(begin_, end_);
+            }
+            catch (...) {
+                // published by done_
+                error_ = std::current_exception();
+            }
+            done_.store(true);
+            wake();
+        }
+        template<typename It>
+        void push(It const &begin, It const &end) {
+            push_range(begin, end, [this](auto &&val) {
+                auto const tail = tail_.load(std::memory_order_relaxed);
+                wait([this, tail]() { return tail - head_.load() <= mask_ || stop_.load(); });
+                if (stop_.load())
+                    return false;
+                new (&at(tail)) row_type(row_traits<row_type>::make(std::forward<decltype(val)>(val)));
+                tail_.store(tail + 1);
+                if (sleepers_.load())
+                    wake();
+                return true;
+            });
+        }
+
+        // the waiter announces itself before its last check under the lock, the other side
+        // publishes before looking for waiters: one of them sees the other
+        template<typename Ready>
+        void wait(Ready const &ready) {
+            for (int i = 0; i < spins; ++i) {
+                if (ready())
+                    return;
+                std::this_thread::yield();
+            }
+            std::unique_lock<std::mutex> guard(lock_);
+            sleepers_.fetch_add(1);
+            moved_.wait(guard, ready);
+            sleepers_.fetch_sub(1);
+        }
+        void wake() {
+            std::lock_guard<std::mutex> guard(lock_);
+            moved_.notify_all();
+        }
+
+        BaseIt const begin_;
+        BaseIt const end_;
+        std::size_t const mask_;
+        std::unique_ptr<slot_t[]> slots_;
+
+        // each side writes its own cache line (operator new of C++14 ignores alignas)
+        char pad_[64];
+        std::atomic<std::size_t> head_{0};
+        char headPad_[64 - sizeof(std::atomic<std::size_t>)];
+        std::atomic<std::size_t> tail_{0};
+        char tailPad_[64 - sizeof(std::atomic<std::size_t>)];
+        std::atomic<bool> done_{false};
+        std::atomic<bool> stop_{false};
+        std::exception_ptr error_;
+        std::atomic<int> sleepers_{0};
+        std::mutex lock_;
+        std::condition_variable moved_;
+        std::thread producer_;
+    };
+
+    // a position in a pipelined query. The producer starts when an enumeration first looks
+    // at its begin iterator and stops with the last copy of it, so each enumeration of the
+    // handle runs its own pipeline; copies of a started iterator share it (single pass)
+    template<typename Base>
+    class pipe_it
+    {
+        using state_t = pipe_state<Base>;
+        using row_t = typename state_t::row_type;
+    public:
+        typedef std::input_iterator_tag                                               iterator_category;
+        typedef decltype(row_value(std::declval<row_t const &>()))                    value_type;
+        typedef std::ptrdiff_t                                                        difference_type;
+        typedef typename std::remove_reference<value_type>::type                      *pointer;
+        typedef value_type                                                            reference;
+
+        pipe_it() = delete;
+        pipe_it(Base const &begin, Base const &end, std::size_t const capacity, bool const last) noexcept(true)
+                : begin_(begin), end_(end), capacity_(capacity), last_(last) {}
+
+        // these start the producer and rethrow what it threw
+        constexpr value_type operator*() const { return row_value(*state().peek()); }
+        constexpr pointer operator->() const { return std::addressof(operator*()); }
+
+        constexpr auto &operator++() {
+            if (state().peek())
+                state().pop();
+            return (*this);
+        }
+        // copies share the ring, so *it++ reads through a proxy holding the row of before
+        constexpr auto operator++(int) { postfix tmp(*state().peek()); operator++(); return (tmp); }
+
+        constexpr bool operator==(pipe_it const &rhs) const {
+            if (last_ || rhs.last_)
+                return (!last_ || rhs.exhausted()) && (!rhs.last_ || exhausted());
+            return state_ == rhs.state_;
+        }
+        constexpr bool operator!=(pipe_it const &rhs) const { return !operator==(rhs); }
+
+        // upstream stages settle here, on the enumerating thread, before any producer runs
+        constexpr void settle() noexcept(nothrow_range<Base>::value) {
+            linq::settle(begin_);
+            linq::settle(end_);
+        }
+
+    private:
+        class postfix
+        {
+        public:
+            explicit postfix(row_t const &row) : row_(row) {}
+            value_type operator*() const noexcept(true) { return row_value(row_); }
+        private:
+            row_t row_;
+        };
+
+        state_t &state() const {
+            if (!state_)
+                state_ = std::make_shared<state_t>(begin_, end_, capacity_);
+            return *state_;
+        }
+        bool exhausted() const { return last_ || !state().peek(); }
+
+        Base begin_;
+        Base end_;
+        std::size_t capacity_;
+        bool last_;
+        mutable std::shared_ptr<state_t> state_;
+    };
+
+    // whether a range is read through a Prefetch stage, found anywhere in its iterator type:
+    // settling its begin may start a pipeline, so every enumeration settles a fresh one
+    template<bool... Bs>
+    struct bool_list {};
+    template<typename T>
+    struct through_pipe : std::false_type {};
+    template<typename Base>
+    struct through_pipe<pipe_it<Base>> : std::true_type {};
+    template<template<typename...> class T, typename... Args>
+    struct through_pipe<T<Args...>>
+            : std::integral_constant<bool, !std::is_same<bool_list<false, through_pipe<Args>::value...>,
+                                                         bool_list<through_pipe<Args>::value..., false>>::value> {};
+
+    template<typename BaseIt>
+    class Pipelined : public TState<pipe_it<BaseIt>> {
+    public:
+        typedef pipe_it<BaseIt> iterator;
+        typedef iterator const_iterator;
+
+        using base_t = TState<iterator>;
+        using Out = typename iterator::value_type;
+    public:
+        ~Pipelined() = default;
+        Pipelined() = delete;
+        Pipelined(Pipelined const &rhs)
+                : base_t(static_cast<base_t const &>(rhs))
+        {}
+        Pipelined(BaseIt const &begin, BaseIt const &end, std::size_t const capacity, stage_context const &context) noexcept(true)
+                : base_t(iterator(begin, end, capacity, false), iterator(begin, end, capacity, true), context)
+        {}
+
+        // the begin iterator of the handle is never started, these run a pipeline of their own
+        constexpr auto first() const {
+            auto const it = this->begin();
+            return typename std::decay<Out>::type(*it);
+        }
+        constexpr auto firstOrDefault() const {
+            auto const it = this->begin();
+            return it != this->end() ? typename std::decay<Out>::type(*it) : typename std::decay<Out>::type{};
+        }
+        constexpr bool any() const {
+            auto const it = this->begin();
+            return it != this->end();
+        }
+    };
+}
+
+#endif // !PIPE_H_
@@ -0,0 +1,203 @@
+#ifndef PUSH_H_
+# define PUSH_H_
+
+namespace linq
+{
+    // push execution: instead of pulling every element back up through the adapter iterators,
+    // each stage wraps the sink of the stage after it and only the source loop remains.
+    // A sink returns false to stop the source early. The loop sets no noexcept boundary of its
+    // own: what a loader throws reaches the terminal running it, or the Prefetch producer
+    // that forwards it to the consumer.
+    template<typename It>
+    struct pusher
+    {
+        template<typename Sink>
+        static constexpr void run(It it, It const &end, Sink &&sink) {
+            for (; it != end; ++it)
+                if (!sink(*it))
+                    return;
+        }
+    };
+    template<typename Base>
+    struct pusher<basic_it<Base>> : pusher<Base>
+    {};
+    template<typename Base, typename Seek>
+    struct pusher<seek_it<Base, Seek>> : pusher<Base>
+    {};
+    template<typename Base, typename Proxy>
+    struct pusher<all_it<Base, Proxy>> : pusher<Base>
+    {};
+    template<typename Base, typename Loader>
+    struct pusher<select_it<Base, Loader>>
+    {
+        template<typename Sink>
+        static constexpr void run(select_it<Base, Loader> const &begin, select_it<Base, Loader> const &end, Sink &&sink) {
+            auto const &loader = begin.loader();
+            pusher<Base>::run(begin, end, [&sink, &loader](auto &&val) {
+                return sink(loader(std::forward<decltype(val)>(val)));
+            });
+        }
+    };
+    template<typename Base, typename Filter>
+    struct pusher<where_it<Base, Filter>>
+    {
+        template<typename Sink>
+        static constexpr void run(where_it<Base, Filter> const &begin, where_it<Base, Filter> const &end, Sink &&sink) {
+            auto const &filter = begin.filter();
+            pusher<Base>::run(begin, end, [&sink, &filter](auto &&val) {
+                return !filter(val) || sink(std::forward<decltype(val)>(val));
+            });
+        }
+    };
+    template<typename Base, typename State>
+    struct pusher<distinct_it<Base, State>>
+    {
+        template<typename Sink>
+        static constexpr void run(distinct_it<Base, State> const &begin, distinct_it<Base, State> const &end, Sink &&sink) {
+            auto const &state = begin.state();
+            auto index = begin.index();
+            pusher<Base>::run(begin, end, [&sink, &state, &index](auto &&val) {
+                return !state.first(index++, val) || sink(std::forward<decltype(val)>(val));
+            });
+        }
+    };
+    template<typename First, typename Second>
+    struct pusher<concat_it<First, Second>>
+    {
+        template<typename Sink>
+        static constexpr void run(concat_it<First, Second> const &begin, concat_it<First, Second> const &end, Sink &&sink) {
+            using value_t = typename concat_it<First, Second>::value_type;
+            bool more = true;
+            auto const forward = [&sink, &more](auto &&val) {
+                return more = sink(static_cast<value_t>(std::forward<decltype(val)>(val)));
+            };
+            pusher<First>::run(begin.first(), end.first(), forward);
+            if (more)
+                pusher<Second>::run(begin.second(), end.second(), forward);
+        }
+    };
+    template<typename State>
+    struct pusher<memo_it<State>>
+    {
+        // the filled prefix is read a segment at a time; past it rows are computed in batches
+        // that double with what the sink already took, so a consumer stopping early costs at
+        // most as many extra rows as it read (and never more than a batch of 64)
+        template<typename Sink>
+        static constexpr void run(memo_it<State> const &begin, memo_it<State> const &end, Sink &&sink) {
+            auto const &state = begin.state();
+            std::size_t ahead = 0;
+            for (auto index = begin.index(); index < end.index();) {
+                auto const span = state.span(index);
+                if (!span.second) {
+                    if (!state.fetch(index, std::min(ahead, end.index() - index - 1)))
+                        return;
+                    ahead = std::min<std::size_t>(ahead * 2 + 1, 63);
+                    continue;
+                }
+                auto const count = std::min(span.second, end.index() - index);
+                for (std::size_t i = 0; i < count; ++i)
+                    if (!sink(span.first[i]))
+                        return;
+                index += count;
+            }
+        }
+    };
+    template<typename Base>
+    struct pusher<chunk_it<Base>>
+    {
+        // past the chunk the iterator holds, the upstream pushes into a buffer handed to the
+        // sink each time it is full
+        template<typename Sink>
+        static constexpr void run(chunk_it<Base> const &begin, chunk_it<Base> const &end, Sink &&sink) {
+            using value_t = typename chunk_it<Base>::value_type;
+            if (begin == end || !sink(*begin))
+                return;
+            auto const width = begin.width();
+            std::shared_ptr<typename chunk_it<Base>::buffer_type> buffer;
+            chunk_it<Base>::reuse(buffer, width);
+            bool more = true;
+            pusher<Base>::run(begin.base(), end.base(), [&sink, &more, &buffer, width](auto &&val) {
+                buffer->push_back(std::forward<decltype(val)>(val));
+                if (buffer->size() < width)
+                    return true;
+                more = sink(value_t(buffer->data(), buffer->size(), buffer));
+                chunk_it<Base>::reuse(buffer, width);
+                return more;
+            });
+            if (more && !buffer->empty())
+                sink(value_t(buffer->data(), buffer->size(), buffer));
+        }
+    };
+    template<typename Base, typename State>
+    struct pusher<join_it<Base, State>>
+    {
+        template<typename Sink>
+        static constexpr void run(join_it<Base, State> const &begin, join_it<Base, State> const &end, Sink &&sink) {
+            // a range cut inside the matches of an outer row is walked element by element
+            if (!end.exhausted()) {
+                for (auto it = begin; it != end; ++it)
+                    if (!sink(*it))
+                        return;
+                return;
+            }
+            if (begin.exhausted())
+                return;
+            auto const &state = begin.state();
+            auto outer = static_cast<Base const &>(begin);
+            for (auto it = begin.current(); it != begin.last(); ++it)
+                if (!sink(state.result(*outer, *it)))
+                    return;
+            auto ordinal = begin.ordinal() + 1;
+            pusher<Base>::run(++outer, end, [&sink, &state, &ordinal](auto &&val) {
+                for (auto &&inner : state.matches(ordinal, val))
+                    if (!sink(state.result(val, inner)))
+                        return false;
+                ++ordinal;
+                return true;
+            });
+        }
+    };
+    template<typename Base, typename State>
+    struct pusher<group_join_it<Base, State>>
+    {
+        template<typename Sink>
+        static constexpr void run(group_join_it<Base, State> const &begin, group_join_it<Base, State> const &end, Sink &&sink) {
+            auto const &state = begin.state();
+            auto ordinal = begin.ordinal();
+            pusher<Base>::run(begin, end, [&sink, &state, &ordinal](auto &&val) {
+                return sink(state.result(val, state.matches(ordinal++, val)));
+            });
+        }
+    };
+    template<typename Base>
+    struct pusher<take_it<Base, int>>
+    {
+        template<typename Sink>
+        static constexpr void run(take_it<Base, int> const &begin, take_it<Base, int> const &end, Sink &&sink) {
+            auto remaining = begin.remaining() - end.remaining();
+            if (remaining <= 0)
+                return;
+            pusher<Base>::run(begin, end, [&sink, &remaining](auto &&val) {
+                return sink(std::forward<decltype(val)>(val)) && --remaining > 0;
+            });
+        }
+    };
+    template<typename Base, typename In>
+    struct pusher<take_it<Base, In>>
+    {
+        template<typename Sink>
+        static constexpr void run(take_it<Base, In> const &begin, take_it<Base, In> const &end, Sink &&sink) {
+            auto const &when = begin.when();
+            pusher<Base>::run(begin, end, [&sink, &when](auto &&val) {
+                return when(val) && sink(std::forward<decltype(val)>(val));
+            });
+        }
+    };
+
+    template<typename It, typename Sink>
+    constexpr void push_range(It const &begin, It const &end, Sink &&sink) {
+        pusher<It>::run(begin, end, std::forward<Sink>(sink));
+    }
+}
+
+#endif // !PUSH_H_
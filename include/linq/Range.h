@@ -0,0 +1,97 @@
+#ifndef RANGE_H_
+# define RANGE_H_
+
+namespace linq
+{
+    // generated sources: an element is computed from its position, so they need no storage,
+    // are random-access and their aggregates have closed forms (see closed_form in Reduce.h)
+    template<typename T>
+    class range_it
+    {
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef T                               value_type;
+        typedef std::ptrdiff_t                  difference_type;
+        typedef T const                         *pointer;
+        typedef T                               reference;
+
+        range_it() = default;
+        range_it(T const &start, T const &step, difference_type const pos) noexcept(true)
+                : start_(start), step_(step), pos_(pos) {}
+
+        constexpr T operator*() const noexcept(true) { return at(pos_); }
+        constexpr T operator[](difference_type const n) const noexcept(true) { return at(pos_ + n); }
+
+        constexpr auto &operator++() noexcept(true) { ++pos_; return (*this); }
+        constexpr auto operator++(int) noexcept(true) { auto tmp = *this; ++pos_; return (tmp); }
+        constexpr auto &operator--() noexcept(true) { --pos_; return (*this); }
+        constexpr auto operator--(int) noexcept(true) { auto tmp = *this; --pos_; return (tmp); }
+        constexpr auto &operator+=(difference_type const n) noexcept(true) { pos_ += n; return (*this); }
+        constexpr auto &operator-=(difference_type const n) noexcept(true) { pos_ -= n; return (*this); }
+        constexpr auto operator+(difference_type const n) const noexcept(true) { return range_it(start_, step_, pos_ + n); }
+        constexpr auto operator-(difference_type const n) const noexcept(true) { return range_it(start_, step_, pos_ - n); }
+        constexpr difference_type operator-(range_it const &rhs) const noexcept(true) { return pos_ - rhs.pos_; }
+        friend constexpr auto operator+(difference_type const n, range_it const &rhs) noexcept(true) { return (rhs + n); }
+
+        constexpr bool operator==(range_it const &rhs) const noexcept(true) { return pos_ == rhs.pos_; }
+        constexpr bool operator!=(range_it const &rhs) const noexcept(true) { return pos_ != rhs.pos_; }
+        constexpr bool operator<(range_it const &rhs) const noexcept(true) { return pos_ < rhs.pos_; }
+        constexpr bool operator>(range_it const &rhs) const noexcept(true) { return pos_ > rhs.pos_; }
+        constexpr bool operator<=(range_it const &rhs) const noexcept(true) { return pos_ <= rhs.pos_; }
+        constexpr bool operator>=(range_it const &rhs) const noexcept(true) { return pos_ >= rhs.pos_; }
+
+        constexpr T at(difference_type const pos) const noexcept(true) {
+            return static_cast<T>(start_ + step_ * static_cast<T>(pos));
+        }
+        constexpr T const &step() const noexcept(true) { return step_; }
+
+    private:
+        T start_;
+        T step_;
+        difference_type pos_;
+    };
+
+    // the repeated value lives once in the stage context, iterators point to it
+    template<typename T>
+    class repeat_it
+    {
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef T const                         &value_type;
+        typedef std::ptrdiff_t                  difference_type;
+        typedef T const                         *pointer;
+        typedef T const                         &reference;
+
+        repeat_it() = default;
+        repeat_it(T const &value, difference_type const pos) noexcept(true)
+                : value_(std::addressof(value)), pos_(pos) {}
+
+        constexpr T const &operator*() const noexcept(true) { return *value_; }
+        constexpr T const *operator->() const noexcept(true) { return value_; }
+        constexpr T const &operator[](difference_type const) const noexcept(true) { return *value_; }
+
+        constexpr auto &operator++() noexcept(true) { ++pos_; return (*this); }
+        constexpr auto operator++(int) noexcept(true) { auto tmp = *this; ++pos_; return (tmp); }
+        constexpr auto &operator--() noexcept(true) { --pos_; return (*this); }
+        constexpr auto operator--(int) noexcept(true) { auto tmp = *this; --pos_; return (tmp); }
+        constexpr auto &operator+=(difference_type const n) noexcept(true) { pos_ += n; return (*this); }
+        constexpr auto &operator-=(difference_type const n) noexcept(true) { pos_ -= n; return (*this); }
+        constexpr auto operator+(difference_type const n) const noexcept(true) { return repeat_it(*value_, pos_ + n); }
+        constexpr auto operator-(difference_type const n) const noexcept(true) { return repeat_it(*value_, pos_ - n); }
+        constexpr difference_type operator-(repeat_it const &rhs) const noexcept(true) { return pos_ - rhs.pos_; }
+        friend constexpr auto operator+(difference_type const n, repeat_it const &rhs) noexcept(true) { return (rhs + n); }
+
+        constexpr bool operator==(repeat_it const &rhs) const noexcept(true) { return pos_ == rhs.pos_; }
+        constexpr bool operator!=(repeat_it const &rhs) const noexcept(true) { return pos_ != rhs.pos_; }
+        constexpr bool operator<(repeat_it const &rhs) const noexcept(true) { return pos_ < rhs.pos_; }
+        constexpr bool operator>(repeat_it const &rhs) const noexcept(true) { return pos_ > rhs.pos_; }
+        constexpr bool operator<=(repeat_it const &rhs) const noexcept(true) { return pos_ <= rhs.pos_; }
+        constexpr bool operator>=(repeat_it const &rhs) const noexcept(true) { return pos_ >= rhs.pos_; }
+
+    private:
+        T const *value_;
+        difference_type pos_;
+    };
+}
+
+#endif // !RANGE_H_
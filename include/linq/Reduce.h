@@ -0,0 +1,449 @@
+#ifndef REDUCE_H_
+# define REDUCE_H_
+
+namespace linq
+{
+    template<typename It, typename Value = typename std::decay<typename std::iterator_traits<It>::value_type>::type>
+    struct is_contiguous_iterator
+            : std::integral_constant<bool, !std::is_same<Value, bool>::value
+                                           && (std::is_same<It, typename std::vector<Value>::iterator>::value
+                                               || std::is_same<It, typename std::vector<Value>::const_iterator>::value
+                                               || std::is_same<It, pointer_it<Value>>::value
+                                               || std::is_same<It, pointer_it<Value const>>::value)>
+    {};
+
+    // describes a pipeline laid over contiguous storage as a raw buffer plus the per-element
+    // keep/load steps of its stages, so terminals can run one flat loop over the buffer
+    template<typename It, typename = void>
+    struct kernel
+    {
+        static constexpr bool value = false;
+    };
+    template<typename It>
+    struct kernel<It, typename std::enable_if<is_contiguous_iterator<It>::value>::type>
+    {
+        using raw_t = typename std::remove_reference<decltype(*std::declval<It>())>::type;
+
+        static constexpr bool value = true;
+        static constexpr bool plain = true;
+
+        static std::pair<raw_t *, std::size_t> data(It const &begin, It const &end) noexcept(true) {
+            auto const size = static_cast<std::size_t>(end - begin);
+            return std::make_pair(size ? std::addressof(*begin) : nullptr, size);
+        }
+        static constexpr bool keep(It const &, raw_t &) noexcept(true) { return true; }
+        static constexpr raw_t &load(It const &, raw_t &raw) noexcept(true) { return raw; }
+    };
+    template<typename Base>
+    struct kernel<basic_it<Base>> : kernel<Base>
+    {};
+    template<typename Base, typename Seek>
+    struct kernel<seek_it<Base, Seek>> : kernel<Base>
+    {};
+    template<typename Base, typename Proxy>
+    struct kernel<all_it<Base, Proxy>> : kernel<Base>
+    {};
+    template<typename Base, typename Loader>
+    struct kernel<select_it<Base, Loader>> : kernel<Base>
+    {
+        static constexpr bool plain = false;
+
+        template<typename Raw>
+        static constexpr decltype(auto) load(select_it<Base, Loader> const &it, Raw &raw) noexcept(true) {
+            return it.loader()(kernel<Base>::load(it, raw));
+        }
+    };
+    template<typename Base, typename Filter>
+    struct kernel<where_it<Base, Filter>> : kernel<Base>
+    {
+        static constexpr bool plain = false;
+
+        template<typename Raw>
+        static constexpr bool keep(where_it<Base, Filter> const &it, Raw &raw) noexcept(true) {
+            return kernel<Base>::keep(it, raw) && it.filter()(kernel<Base>::load(it, raw));
+        }
+    };
+
+    template<typename It>
+    using reduce_t = typename std::remove_const<typename std::remove_reference<typename It::value_type>::type>::type;
+
+    // generated sources answer Sum/Min/Max/Contains from their first element, step and length
+    template<typename It>
+    struct closed_form
+    {
+        static constexpr bool value = false;
+    };
+    template<typename Base>
+    struct closed_form<basic_it<Base>> : closed_form<Base>
+    {};
+    template<typename Base, typename Seek>
+    struct closed_form<seek_it<Base, Seek>> : closed_form<Base>
+    {};
+    template<typename T>
+    struct closed_form<range_it<T>>
+    {
+        static constexpr bool value = std::is_arithmetic<T>::value;
+
+        static T sum(range_it<T> const &begin, range_it<T> const &end) noexcept(true) {
+            auto const n = end - begin;
+            return n > 0 ? static_cast<T>(static_cast<T>(n) * *begin + begin.step() * static_cast<T>(n * (n - 1) / 2)) : T{};
+        }
+        static T min(range_it<T> const &begin, range_it<T> const &end) noexcept(true) {
+            return end - begin > 0 ? (begin.step() < T{} ? *(end - 1) : *begin) : T{};
+        }
+        static T max(range_it<T> const &begin, range_it<T> const &end) noexcept(true) {
+            return end - begin > 0 ? (begin.step() < T{} ? *begin : *(end - 1)) : T{};
+        }
+        template<typename V>
+        static bool contains(range_it<T> const &begin, range_it<T> const &end, V const &value) noexcept(true) {
+            auto const n = end - begin;
+            if (n <= 0)
+                return false;
+            if (begin.step() == T{})
+                return *begin == value;
+            // the candidate position, and its neighbour for rounding of floating steps
+            auto const k = static_cast<std::ptrdiff_t>((value - *begin) / begin.step());
+            return (k >= 0 && k < n && begin[k] == value) || (k + 1 >= 0 && k + 1 < n && begin[k + 1] == value);
+        }
+    };
+    template<typename T>
+    struct closed_form<repeat_it<T>>
+    {
+        static constexpr bool value = std::is_arithmetic<T>::value;
+
+        static T sum(repeat_it<T> const &begin, repeat_it<T> const &end) noexcept(true) {
+            return end - begin > 0 ? static_cast<T>(static_cast<T>(end - begin) * *begin) : T{};
+        }
+        static T min(repeat_it<T> const &begin, repeat_it<T> const &end) noexcept(true) {
+            return end - begin > 0 ? *begin : T{};
+        }
+        static T max(repeat_it<T> const &begin, repeat_it<T> const &end) noexcept(true) {
+            return end - begin > 0 ? *begin : T{};
+        }
+        template<typename V>
+        static bool contains(repeat_it<T> const &begin, repeat_it<T> const &end, V const &value) noexcept(true) {
+            return end - begin > 0 && *begin == value;
+        }
+    };
+    template<typename It>
+    using use_kernel = std::integral_constant<bool, kernel<It>::value && std::is_arithmetic<reduce_t<It>>::value>;
+
+    // the start of a branch-free min (max): no value is above (below) it, infinities included
+    template<typename T>
+    constexpr T min_seed() noexcept(true) {
+        return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max();
+    }
+    template<typename T>
+    constexpr T max_seed() noexcept(true) {
+        return std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::lowest();
+    }
+
+    namespace detail
+    {
+        template<typename It>
+        reduce_t<It> sum(It const &begin, It const &end, std::false_type) noexcept(nothrow_range<It>::value) {
+            reduce_t<It> result{};
+            push_range(begin, end, [&result](auto &&val) {
+                result += val;
+                return true;
+            });
+            return result;
+        }
+        template<typename It, typename Raw>
+        reduce_t<It> sum(It const &, std::pair<Raw *, std::size_t> const &data, std::true_type) noexcept(true) {
+            return simd::sum(data.first, data.second);
+        }
+        // filters stay branch-free over the buffer: the compiler turns keep() into a compare mask
+        template<typename It, typename Raw>
+        reduce_t<It> sum(It const &begin, std::pair<Raw *, std::size_t> const &data, std::false_type) noexcept(true) {
+            reduce_t<It> result{};
+            for (std::size_t i = 0; i < data.second; ++i)
+            {
+                auto &raw = data.first[i];
+                if (kernel<It>::keep(begin, raw))
+                    result += kernel<It>::load(begin, raw);
+            }
+            return result;
+        }
+        template<typename It>
+        reduce_t<It> sum(It const &begin, It const &end, std::true_type) noexcept(true) {
+            return sum(begin, kernel<It>::data(begin, end), std::integral_constant<bool, kernel<It>::plain>{});
+        }
+
+        template<typename It, typename Compare>
+        reduce_t<It> extremum(It const &begin, It const &end, Compare const &cmp, std::false_type) noexcept(nothrow_range<It>::value) {
+            reduce_t<It> result(*begin);
+            push_range(begin, end, [&result, &cmp](auto &&val) {
+                if (cmp(val, result))
+                    result = val;
+                return true;
+            });
+            return result;
+        }
+        template<typename It, typename Raw>
+        reduce_t<It> extremum(It const &, std::pair<Raw *, std::size_t> const &data, std::less<>, std::true_type) noexcept(true) {
+            return simd::min(data.first, data.second);
+        }
+        template<typename It, typename Raw>
+        reduce_t<It> extremum(It const &, std::pair<Raw *, std::size_t> const &data, std::greater<>, std::true_type) noexcept(true) {
+            return simd::max(data.first, data.second);
+        }
+        template<typename It, typename Raw, typename Compare>
+        reduce_t<It> extremum(It const &begin, std::pair<Raw *, std::size_t> const &data, Compare const &cmp, std::false_type) noexcept(true) {
+            using value_t = reduce_t<It>;
+            value_t val = cmp(std::numeric_limits<value_t>::lowest(), std::numeric_limits<value_t>::max())
+                          ? min_seed<value_t>() : max_seed<value_t>();
+            bool found = false;
+            for (std::size_t i = 0; i < data.second; ++i)
+            {
+                auto &raw = data.first[i];
+                bool const keep = kernel<It>::keep(begin, raw);
+                found |= keep;
+                if (keep)
+                {
+                    value_t const loaded = kernel<It>::load(begin, raw);
+                    val = cmp(loaded, val) ? loaded : val;
+                }
+            }
+            return found ? val : value_t{};
+        }
+        template<typename It, typename Compare>
+        reduce_t<It> extremum(It const &begin, It const &end, Compare const &cmp, std::true_type) noexcept(true) {
+            return extremum(begin, kernel<It>::data(begin, end), cmp, std::integral_constant<bool, kernel<It>::plain>{});
+        }
+
+        template<typename It>
+        std::size_t count(It const &begin, It const &end, std::random_access_iterator_tag) noexcept(true) {
+            return static_cast<std::size_t>(end - begin);
+        }
+        template<typename It>
+        std::size_t count(It const &begin, It const &end, std::input_iterator_tag) noexcept(nothrow_range<It>::value) {
+            std::size_t number{ 0 };
+            push_range(begin, end, [&number](auto &&) { return ++number, true; });
+            return number;
+        }
+        template<typename It>
+        reduce_t<It> sum(It const &begin, It const &end, std::false_type, std::false_type) noexcept(nothrow_range<It>::value) {
+            return sum(begin, end, std::false_type{});
+        }
+        template<typename It>
+        reduce_t<It> sum(It const &begin, It const &end, std::true_type, std::false_type) noexcept(true) {
+            return sum(begin, end, std::true_type{});
+        }
+        template<typename It, typename Kernel>
+        reduce_t<It> sum(It const &begin, It const &end, Kernel, std::true_type) noexcept(true) {
+            return closed_form<It>::sum(begin, end);
+        }
+        template<typename It>
+        reduce_t<It> min(It const &begin, It const &end, std::false_type) noexcept(nothrow_range<It>::value) {
+            return extremum(begin, end, std::less<>(), use_kernel<It>{});
+        }
+        template<typename It>
+        reduce_t<It> min(It const &begin, It const &end, std::true_type) noexcept(true) {
+            return closed_form<It>::min(begin, end);
+        }
+        template<typename It>
+        reduce_t<It> max(It const &begin, It const &end, std::false_type) noexcept(nothrow_range<It>::value) {
+            return extremum(begin, end, std::greater<>(), use_kernel<It>{});
+        }
+        template<typename It>
+        reduce_t<It> max(It const &begin, It const &end, std::true_type) noexcept(true) {
+            return closed_form<It>::max(begin, end);
+        }
+        template<typename It, typename T>
+        bool contains(It const &begin, It const &end, T const &elem, std::false_type) noexcept(nothrow_range<It>::value) {
+            bool found = false;
+            push_range(begin, end, [&found, &elem](auto &&it) {
+                return !(found = it == elem);
+            });
+            return found;
+        }
+        template<typename It, typename T>
+        bool contains(It const &begin, It const &end, T const &elem, std::true_type) noexcept(true) {
+            return closed_form<It>::contains(begin, end, elem);
+        }
+    }
+
+    template<typename It>
+    using use_closed_form = std::integral_constant<bool, closed_form<It>::value>;
+
+    template<typename It>
+    reduce_t<It> sum_range(It const &begin, It const &end) noexcept(nothrow_range<It>::value) {
+        return detail::sum(begin, end, use_kernel<It>{}, use_closed_form<It>{});
+    }
+    template<typename It>
+    std::size_t count_range(It const &begin, It const &end) noexcept(nothrow_range<It>::value) {
+        auto const hint = size_range(begin, end);
+        return hint.exact ? hint.size : detail::count(begin, end, typename std::iterator_traits<It>::iterator_category{});
+    }
+    template<typename It>
+    reduce_t<It> min_range(It const &begin, It const &end) noexcept(nothrow_range<It>::value) {
+        return detail::min(begin, end, use_closed_form<It>{});
+    }
+    template<typename It>
+    reduce_t<It> max_range(It const &begin, It const &end) noexcept(nothrow_range<It>::value) {
+        return detail::max(begin, end, use_closed_form<It>{});
+    }
+    template<typename It, typename T>
+    bool contains_range(It const &begin, It const &end, T const &elem) noexcept(nothrow_range<It>::value) {
+        return detail::contains(begin, end, elem, use_closed_form<It>{});
+    }
+
+    // Aggregate(linq::agg::sum, linq::agg::min, ...) computes several aggregates in one pass:
+    // one accumulator per tag, all fed by the same loop. The tags get their own namespace so
+    // that they cannot collide with std::min/std::max or with min/max macros
+    namespace agg
+    {
+        struct sum_t {};
+        struct min_t {};
+        struct max_t {};
+        struct count_t {};
+        struct avg_t {};
+        constexpr sum_t sum{};
+        constexpr min_t min{};
+        constexpr max_t max{};
+        constexpr count_t count{};
+        constexpr avg_t avg{};
+    }
+
+    template<typename Tag, typename T, typename = void>
+    struct accumulator;
+    template<typename T>
+    struct accumulator<agg::sum_t, T>
+    {
+        T value{};
+
+        constexpr void add(T const &in, bool) noexcept(true) { value += in; }
+        constexpr T result(std::size_t) const noexcept(true) { return value; }
+    };
+    template<typename T>
+    struct accumulator<agg::count_t, T>
+    {
+        constexpr void add(T const &, bool) noexcept(true) {}
+        constexpr std::size_t result(std::size_t const count) const noexcept(true) { return count; }
+    };
+    template<typename T>
+    struct accumulator<agg::avg_t, T>
+    {
+        typedef typename std::conditional<std::is_floating_point<T>::value, T, double>::type value_type;
+        value_type value{};
+
+        constexpr void add(T const &in, bool) noexcept(true) { value += static_cast<value_type>(in); }
+        constexpr value_type result(std::size_t const count) const noexcept(true) {
+            return count ? value / static_cast<value_type>(count) : value_type{};
+        }
+    };
+    // arithmetic extrema start from the opposite limit so the update is a branch-free select
+    template<typename T>
+    struct accumulator<agg::min_t, T, typename std::enable_if<std::is_arithmetic<T>::value>::type>
+    {
+        T value = min_seed<T>();
+
+        constexpr void add(T const &in, bool) noexcept(true) { value = in < value ? in : value; }
+        constexpr T result(std::size_t const count) const noexcept(true) { return count ? value : T{}; }
+    };
+    template<typename T>
+    struct accumulator<agg::max_t, T, typename std::enable_if<std::is_arithmetic<T>::value>::type>
+    {
+        T value = max_seed<T>();
+
+        constexpr void add(T const &in, bool) noexcept(true) { value = value < in ? in : value; }
+        constexpr T result(std::size_t const count) const noexcept(true) { return count ? value : T{}; }
+    };
+    template<typename T>
+    struct accumulator<agg::min_t, T, typename std::enable_if<!std::is_arithmetic<T>::value>::type>
+    {
+        T value{};
+
+        constexpr void add(T const &in, bool const first) { if (first || in < value) value = in; }
+        constexpr T const &result(std::size_t) const noexcept(true) { return value; }
+    };
+    template<typename T>
+    struct accumulator<agg::max_t, T, typename std::enable_if<!std::is_arithmetic<T>::value>::type>
+    {
+        T value{};
+
+        constexpr void add(T const &in, bool const first) { if (first || value < in) value = in; }
+        constexpr T const &result(std::size_t) const noexcept(true) { return value; }
+    };
+
+    template<typename T>
+    struct is_aggregate : std::false_type {};
+    template<>
+    struct is_aggregate<agg::sum_t> : std::true_type {};
+    template<>
+    struct is_aggregate<agg::min_t> : std::true_type {};
+    template<>
+    struct is_aggregate<agg::max_t> : std::true_type {};
+    template<>
+    struct is_aggregate<agg::count_t> : std::true_type {};
+    template<>
+    struct is_aggregate<agg::avg_t> : std::true_type {};
+
+    template<typename... Tags>
+    struct all_aggregates : std::true_type {};
+    template<typename Tag, typename... Tags>
+    struct all_aggregates<Tag, Tags...>
+            : std::integral_constant<bool, is_aggregate<Tag>::value && all_aggregates<Tags...>::value> {};
+
+    namespace detail
+    {
+        template<typename T, typename... Tags>
+        class fused
+        {
+        public:
+            constexpr void add(T const &in) noexcept(true) {
+                add(in, std::index_sequence_for<Tags...>{});
+                ++count_;
+            }
+            constexpr auto result() const noexcept(true) {
+                return result(std::index_sequence_for<Tags...>{});
+            }
+
+        private:
+            template<std::size_t... I>
+            constexpr void add(T const &in, std::index_sequence<I...>) noexcept(true) {
+                bool const first = !count_;
+                (void) first;
+                (void) std::initializer_list<int>{(std::get<I>(accs_).add(in, first), 0)...};
+            }
+            template<std::size_t... I>
+            constexpr auto result(std::index_sequence<I...>) const noexcept(true) {
+                return std::make_tuple(std::get<I>(accs_).result(count_)...);
+            }
+
+            std::tuple<accumulator<Tags, T>...> accs_;
+            std::size_t count_ = 0;
+        };
+
+        template<typename It, typename... Tags>
+        auto aggregate(It const &begin, It const &end, std::false_type) {
+            fused<reduce_t<It>, Tags...> acc;
+            push_range(begin, end, [&acc](auto &&val) {
+                acc.add(val);
+                return true;
+            });
+            return acc.result();
+        }
+        // one flat loop over the buffer, the accumulators stay in registers
+        template<typename It, typename... Tags>
+        auto aggregate(It const &begin, It const &end, std::true_type) noexcept(true) {
+            fused<reduce_t<It>, Tags...> acc;
+            auto const data = kernel<It>::data(begin, end);
+            for (std::size_t i = 0; i < data.second; ++i)
+            {
+                auto &raw = data.first[i];
+                if (kernel<It>::keep(begin, raw))
+                    acc.add(kernel<It>::load(begin, raw));
+            }
+            return acc.result();
+        }
+    }
+
+    template<typename It, typename... Tags>
+    auto aggregate_range(It const &begin, It const &end, Tags const &...) {
+        return detail::aggregate<It, Tags...>(begin, end, use_kernel<It>{});
+    }
+}
+
+#endif // !REDUCE_H_
@@ -4,7 +4,8 @@
 namespace linq
 {
     template <typename Base, typename Loader>
-    class select_it : public Base {
+    class select_it : public Base, private closure_ref<Loader, select_it<Base, Loader>> {
+        using closure_t = closure_ref<Loader, select_it<Base, Loader>>;
     public:
         typedef Base base;
         typedef typename Base::iterator_category                            iterator_category;
@@ -15,41 +16,72 @@ namespace linq
 
         select_it() = delete;
         select_it(select_it const &rhs) = default;
-        select_it(Base const &base, Loader const &loader) noexcept(true)
-                : Base(base), loader_(loader)
+        select_it(Base const &base, closure_t const &loader) noexcept(true)
+                : Base(base), closure_t(loader)
         {}
 
         constexpr auto const &operator=(select_it const &rhs) noexcept(true) {
-            static_cast<Base>(*this) = static_cast<Base const &>(rhs);
+            static_cast<Base &>(*this) = static_cast<Base const &>(rhs);
             return *this;
         }
-        constexpr auto const &operator++() noexcept(true) {
+        constexpr auto const &operator++() noexcept(nothrow_range<Base>::value) {
             static_cast<Base &>(*this).operator++();
             return (*this);
         }
-        constexpr auto operator++(int) noexcept(true) {
+        constexpr auto operator++(int) noexcept(nothrow_range<Base>::value) {
             auto tmp = *this;
             operator++();
             return (tmp);
         }
-        constexpr auto const &operator--() noexcept(true) {
+        constexpr auto const &operator--() noexcept(nothrow_range<Base>::value) {
             static_cast<Base &>(*this).operator--();
             return (*this);
         }
-        constexpr auto operator--(int) noexcept(true) {
+        constexpr auto operator--(int) noexcept(nothrow_range<Base>::value) {
             auto tmp = *this;
             operator--();
             return (tmp);
         }
-        constexpr value_type operator*() const noexcept(true) {
-            return loader_(*static_cast<Base const &>(*this));
+        constexpr auto const &operator+=(difference_type const n) noexcept(nothrow_range<Base>::value) {
+            static_cast<Base &>(*this) += n;
+            return (*this);
+        }
+        constexpr auto const &operator-=(difference_type const n) noexcept(nothrow_range<Base>::value) {
+            static_cast<Base &>(*this) -= n;
+            return (*this);
+        }
+        constexpr auto operator+(difference_type const n) const noexcept(nothrow_range<Base>::value) {
+            auto tmp = *this;
+            tmp += n;
+            return (tmp);
+        }
+        constexpr auto operator-(difference_type const n) const noexcept(nothrow_range<Base>::value) {
+            auto tmp = *this;
+            tmp -= n;
+            return (tmp);
+        }
+        constexpr difference_type operator-(select_it const &rhs) const noexcept(nothrow_range<Base>::value) {
+            return static_cast<Base const &>(*this) - static_cast<Base const &>(rhs);
         }
-        constexpr value_type operator->() const noexcept(true) {
+        constexpr value_type operator[](difference_type const n) const noexcept(nothrow_range<Base>::value) {
+            return loader()(static_cast<Base const &>(*this)[n]);
+        }
+        friend constexpr auto operator+(difference_type const n, select_it const &rhs) noexcept(nothrow_range<Base>::value) {
+            return (rhs + n);
+        }
+        constexpr value_type operator*() const noexcept(nothrow_range<Base>::value) {
+            return loader()(*static_cast<Base const &>(*this));
+        }
+        constexpr value_type operator->() const noexcept(nothrow_range<Base>::value) {
             return *(*this);
         }
 
-    private:
-        Loader const loader_;
+        constexpr void settle() noexcept(nothrow_range<Base>::value) {
+            linq::settle(static_cast<Base &>(*this));
+        }
+
+        constexpr Loader const &loader() const noexcept(true) { return closure_t::get(); }
+        constexpr closure_t const &closure() const noexcept(true) { return *this; }
     };
 
     template<typename BaseIt, typename Loader>
@@ -68,8 +100,13 @@ namespace linq
                 : base_t(static_cast<base_t const &>(rhs))
         {}
 
-        Select(BaseIt const &begin, BaseIt const &end, Loader const &loader)
-                : base_t(iterator(begin, loader), iterator(end, loader))
+        Select(BaseIt const &begin, BaseIt const &end, Loader const &loader, stage_context const &upstream)
+                : Select(begin, end, hold(loader, upstream))
+        {}
+
+    private:
+        Select(BaseIt const &begin, BaseIt const &end, held_closure<Loader> const &loader)
+                : base_t(iterator(begin, loader), iterator(end, loader), loader.context)
         {}
     };
 }
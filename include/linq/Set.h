@@ -0,0 +1,129 @@
+#ifndef SET_H_
+# define SET_H_
+
+namespace linq
+{
+    enum class set_op
+    {
+        unite,
+        intersect,
+        except
+    };
+
+    // builds Union/Intersect/Except in order of first occurrence in the left input, hashing
+    // whichever side is known to be smaller: the left one is then streamed a second time
+    // instead of hashing the larger right one. Without both sizes, or when the left input
+    // is single-pass, the right one is hashed and the left one streamed once
+    template<set_op Op, typename Lhs, typename Rhs>
+    class set_builder
+    {
+        template<typename Source>
+        using forward_t = std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<
+                typename std::decay<decltype(std::declval<Source const &>().begin())>::type>::iterator_category>;
+        using value_t = typename std::decay<decltype(*std::declval<Lhs const &>().begin())>::type;
+        using flags_t = typename map_type<value_t, bool, default_allocator>::type;
+    public:
+        typedef std::vector<value_t> container_type;
+
+        set_builder(Lhs const &lhs, Rhs const &rhs)
+                : lhs_(lhs), rhs_(rhs) {}
+
+        void operator()(container_type &out) const {
+            run(out, std::integral_constant<set_op, Op>{});
+        }
+
+    private:
+        template<typename Source, typename Func>
+        static void each(Source const &source, Func const &func) {
+            push_range(source.begin(), source.end(), [&func](auto &&val) {
+                func(val);
+                return true;
+            });
+        }
+
+        template<typename Table, typename Source>
+        static void reserve(Table &table, Source const &source) {
+            auto const hint = size_range(source.begin(), source.end());
+            if (hint.exact)
+                reserve_table(table, hint.size);
+        }
+
+        bool left_smaller() const noexcept(true) {
+            if (!forward_t<Lhs>::value || !forward_t<Rhs>::value)
+                return false;
+            auto const lhs = size_range(lhs_.begin(), lhs_.end());
+            auto const rhs = size_range(rhs_.begin(), rhs_.end());
+            return lhs.exact && rhs.exact && lhs.size <= rhs.size;
+        }
+
+        void run(container_type &out, std::integral_constant<set_op, set_op::unite>) const {
+            typename set_type<value_t, default_allocator>::type seen;
+            auto const keep = [&seen, &out](value_t const &val) {
+                if (seen.insert(val).second)
+                    out.push_back(val);
+            };
+            each(lhs_, keep);
+            each(rhs_, keep);
+        }
+
+        void run(container_type &out, std::integral_constant<set_op, set_op::intersect>) const {
+            flags_t flags;
+            if (left_smaller()) {
+                reserve(flags, lhs_);
+                each(lhs_, [&flags](value_t const &val) { flags.emplace(val, false); });
+                each(rhs_, [&flags](value_t const &val) {
+                    auto const it = flags.find(val);
+                    if (it != flags.end())
+                        it->second = true;
+                });
+                each(lhs_, [&flags, &out](value_t const &val) {
+                    auto &hit = flags.find(val)->second;
+                    if (hit)
+                        out.push_back(val);
+                    hit = false;
+                });
+                return;
+            }
+            reserve(flags, rhs_);
+            each(rhs_, [&flags](value_t const &val) { flags.emplace(val, true); });
+            each(lhs_, [&flags, &out](value_t const &val) {
+                auto const it = flags.find(val);
+                if (it != flags.end() && it->second) {
+                    out.push_back(val);
+                    it->second = false;
+                }
+            });
+        }
+
+        void run(container_type &out, std::integral_constant<set_op, set_op::except>) const {
+            flags_t flags;
+            if (left_smaller()) {
+                reserve(flags, lhs_);
+                each(lhs_, [&flags](value_t const &val) { flags.emplace(val, true); });
+                each(rhs_, [&flags](value_t const &val) {
+                    auto const it = flags.find(val);
+                    if (it != flags.end())
+                        it->second = false;
+                });
+                each(lhs_, [&flags, &out](value_t const &val) {
+                    auto &keep = flags.find(val)->second;
+                    if (keep)
+                        out.push_back(val);
+                    keep = false;
+                });
+                return;
+            }
+            reserve(flags, rhs_);
+            each(rhs_, [&flags](value_t const &val) { flags.emplace(val, false); });
+            each(lhs_, [&flags, &out](value_t const &val) {
+                if (flags.emplace(val, false).second)
+                    out.push_back(val);
+            });
+        }
+
+        Lhs const lhs_;
+        Rhs const rhs_;
+    };
+}
+
+#endif // !SET_H_
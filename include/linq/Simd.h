@@ -0,0 +1,176 @@
+#ifndef SIMD_H_
+# define SIMD_H_
+
+# if !defined(LINQ_NO_SIMD) && defined(__AVX2__)
+#  define LINQ_SIMD_AVX2
+#  include <immintrin.h>
+# elif !defined(LINQ_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+#  define LINQ_SIMD_SSE2
+#  include <emmintrin.h>
+# endif
+
+namespace linq
+{
+    namespace simd
+    {
+        // scalar fallbacks, four independent accumulators so the loop is not latency bound
+
+        template<typename T>
+        T sum(T const *data, std::size_t const size) noexcept(true)
+        {
+            T acc[4] = {};
+            std::size_t i = 0;
+            for (; i + 4 <= size; i += 4)
+            {
+                acc[0] += data[i];
+                acc[1] += data[i + 1];
+                acc[2] += data[i + 2];
+                acc[3] += data[i + 3];
+            }
+            for (; i < size; ++i)
+                acc[0] += data[i];
+            return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+        }
+        template<typename T>
+        T min(T const *data, std::size_t const size) noexcept(true)
+        {
+            T val = size ? data[0] : T{};
+            for (std::size_t i = 1; i < size; ++i)
+                val = data[i] < val ? data[i] : val;
+            return val;
+        }
+        template<typename T>
+        T max(T const *data, std::size_t const size) noexcept(true)
+        {
+            T val = size ? data[0] : T{};
+            for (std::size_t i = 1; i < size; ++i)
+                val = data[i] > val ? data[i] : val;
+            return val;
+        }
+
+# if defined(LINQ_SIMD_AVX2)
+        namespace detail
+        {
+            struct add
+            {
+                __m256i operator()(__m256i const a, __m256i const b) const { return _mm256_add_epi32(a, b); }
+                __m256 operator()(__m256 const a, __m256 const b) const { return _mm256_add_ps(a, b); }
+                __m256d operator()(__m256d const a, __m256d const b) const { return _mm256_add_pd(a, b); }
+                template<typename T>
+                T operator()(T const a, T const b) const { return a + b; }
+            };
+            struct lower
+            {
+                __m256i operator()(__m256i const a, __m256i const b) const { return _mm256_min_epi32(a, b); }
+                __m256 operator()(__m256 const a, __m256 const b) const { return _mm256_min_ps(a, b); }
+                __m256d operator()(__m256d const a, __m256d const b) const { return _mm256_min_pd(a, b); }
+                template<typename T>
+                T operator()(T const a, T const b) const { return a < b ? a : b; }
+            };
+            struct upper
+            {
+                __m256i operator()(__m256i const a, __m256i const b) const { return _mm256_max_epi32(a, b); }
+                __m256 operator()(__m256 const a, __m256 const b) const { return _mm256_max_ps(a, b); }
+                __m256d operator()(__m256d const a, __m256d const b) const { return _mm256_max_pd(a, b); }
+                template<typename T>
+                T operator()(T const a, T const b) const { return a > b ? a : b; }
+            };
+            inline __m256i load(int const *p) noexcept(true) { return _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p)); }
+            inline __m256 load(float const *p) noexcept(true) { return _mm256_loadu_ps(p); }
+            inline __m256d load(double const *p) noexcept(true) { return _mm256_loadu_pd(p); }
+            inline __m256i broadcast(int const v) noexcept(true) { return _mm256_set1_epi32(v); }
+            inline __m256 broadcast(float const v) noexcept(true) { return _mm256_set1_ps(v); }
+            inline __m256d broadcast(double const v) noexcept(true) { return _mm256_set1_pd(v); }
+        }
+# elif defined(LINQ_SIMD_SSE2)
+        namespace detail
+        {
+            // SSE2 has no 32-bit integer min/max, select through the comparison mask instead
+            inline __m128i select(__m128i const mask, __m128i const a, __m128i const b) noexcept(true)
+            {
+                return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+            }
+            struct add
+            {
+                __m128i operator()(__m128i const a, __m128i const b) const { return _mm_add_epi32(a, b); }
+                __m128 operator()(__m128 const a, __m128 const b) const { return _mm_add_ps(a, b); }
+                __m128d operator()(__m128d const a, __m128d const b) const { return _mm_add_pd(a, b); }
+                template<typename T>
+                T operator()(T const a, T const b) const { return a + b; }
+            };
+            struct lower
+            {
+                __m128i operator()(__m128i const a, __m128i const b) const { return select(_mm_cmplt_epi32(a, b), a, b); }
+                __m128 operator()(__m128 const a, __m128 const b) const { return _mm_min_ps(a, b); }
+                __m128d operator()(__m128d const a, __m128d const b) const { return _mm_min_pd(a, b); }
+                template<typename T>
+                T operator()(T const a, T const b) const { return a < b ? a : b; }
+            };
+            struct upper
+            {
+                __m128i operator()(__m128i const a, __m128i const b) const { return select(_mm_cmpgt_epi32(a, b), a, b); }
+                __m128 operator()(__m128 const a, __m128 const b) const { return _mm_max_ps(a, b); }
+                __m128d operator()(__m128d const a, __m128d const b) const { return _mm_max_pd(a, b); }
+                template<typename T>
+                T operator()(T const a, T const b) const { return a > b ? a : b; }
+            };
+            inline __m128i load(int const *p) noexcept(true) { return _mm_loadu_si128(reinterpret_cast<__m128i const *>(p)); }
+            inline __m128 load(float const *p) noexcept(true) { return _mm_loadu_ps(p); }
+            inline __m128d load(double const *p) noexcept(true) { return _mm_loadu_pd(p); }
+            inline __m128i broadcast(int const v) noexcept(true) { return _mm_set1_epi32(v); }
+            inline __m128 broadcast(float const v) noexcept(true) { return _mm_set1_ps(v); }
+            inline __m128d broadcast(double const v) noexcept(true) { return _mm_set1_pd(v); }
+        }
+# endif
+
+# if defined(LINQ_SIMD_AVX2) || defined(LINQ_SIMD_SSE2)
+        namespace detail
+        {
+            template<typename T, typename Reg, std::size_t Lanes, typename Op>
+            T fold(T const *data, std::size_t const size, Reg const seed, Op const &op) noexcept(true)
+            {
+                Reg acc[4] = { seed, seed, seed, seed };
+                std::size_t i = 0;
+                for (; i + 4 * Lanes <= size; i += 4 * Lanes)
+                {
+                    acc[0] = op(load(data + i), acc[0]);
+                    acc[1] = op(load(data + i + Lanes), acc[1]);
+                    acc[2] = op(load(data + i + 2 * Lanes), acc[2]);
+                    acc[3] = op(load(data + i + 3 * Lanes), acc[3]);
+                }
+                for (; i + Lanes <= size; i += Lanes)
+                    acc[0] = op(load(data + i), acc[0]);
+                acc[0] = op(op(acc[0], acc[1]), op(acc[2], acc[3]));
+
+                T lanes[Lanes];
+                std::memcpy(lanes, &acc[0], sizeof(lanes));
+                T val = lanes[0];
+                for (std::size_t l = 1; l < Lanes; ++l)
+                    val = op(lanes[l], val);
+                for (; i < size; ++i)
+                    val = op(data[i], val);
+                return val;
+            }
+
+            template<typename T, typename Op>
+            T run(T const *data, std::size_t const size, T const seed, Op const &op) noexcept(true)
+            {
+                using reg_t = decltype(load(data));
+                return fold<T, reg_t, sizeof(reg_t) / sizeof(T)>(data, size, broadcast(seed), op);
+            }
+        }
+
+        inline int sum(int const *data, std::size_t const size) noexcept(true) { return detail::run(data, size, 0, detail::add()); }
+        inline float sum(float const *data, std::size_t const size) noexcept(true) { return detail::run(data, size, 0.f, detail::add()); }
+        inline double sum(double const *data, std::size_t const size) noexcept(true) { return detail::run(data, size, 0., detail::add()); }
+        inline int min(int const *data, std::size_t const size) noexcept(true) { return size ? detail::run(data, size, data[0], detail::lower()) : 0; }
+        inline float min(float const *data, std::size_t const size) noexcept(true) { return size ? detail::run(data, size, data[0], detail::lower()) : 0.f; }
+        inline double min(double const *data, std::size_t const size) noexcept(true) { return size ? detail::run(data, size, data[0], detail::lower()) : 0.; }
+        inline int max(int const *data, std::size_t const size) noexcept(true) { return size ? detail::run(data, size, data[0], detail::upper()) : 0; }
+        inline float max(float const *data, std::size_t const size) noexcept(true) { return size ? detail::run(data, size, data[0], detail::upper()) : 0.f; }
+        inline double max(double const *data, std::size_t const size) noexcept(true) { return size ? detail::run(data, size, data[0], detail::upper()) : 0.; }
+# endif
+    }
+}
+
+#endif // !SIMD_H_
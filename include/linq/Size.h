@@ -0,0 +1,144 @@
+#ifndef SIZE_H_
+# define SIZE_H_
+
+namespace linq
+{
+    // what a stage can tell about its length without running: the exact size, or only an
+    // upper bound (unknown_size when even that is missing)
+    constexpr std::size_t unknown_size = std::numeric_limits<std::size_t>::max();
+
+    struct size_hint
+    {
+        std::size_t size;
+        bool exact;
+    };
+
+    template<typename It>
+    struct sizer
+    {
+        static constexpr size_hint run(It const &begin, It const &end) noexcept(true) {
+            return run(begin, end, typename std::iterator_traits<It>::iterator_category{});
+        }
+
+    private:
+        static constexpr size_hint run(It const &begin, It const &end, std::random_access_iterator_tag) noexcept(true) {
+            return size_hint{static_cast<std::size_t>(end - begin), true};
+        }
+        static constexpr size_hint run(It const &, It const &, std::input_iterator_tag) noexcept(true) {
+            return size_hint{unknown_size, false};
+        }
+    };
+    template<typename Base>
+    struct sizer<basic_it<Base>> : sizer<Base>
+    {};
+    template<typename Base, typename Seek>
+    struct sizer<seek_it<Base, Seek>> : sizer<Base>
+    {};
+    template<typename Base, typename Proxy>
+    struct sizer<all_it<Base, Proxy>> : sizer<Base>
+    {};
+    template<typename Base, typename Loader>
+    struct sizer<select_it<Base, Loader>> : sizer<Base>
+    {};
+    template<typename Base, typename Filter>
+    struct sizer<where_it<Base, Filter>>
+    {
+        static constexpr size_hint run(Base const &begin, Base const &end) noexcept(true) {
+            return size_hint{sizer<Base>::run(begin, end).size, false};
+        }
+    };
+    template<typename Base, typename State>
+    struct sizer<distinct_it<Base, State>>
+    {
+        static constexpr size_hint run(Base const &begin, Base const &end) noexcept(true) {
+            return size_hint{sizer<Base>::run(begin, end).size, false};
+        }
+    };
+    template<typename Base, typename State>
+    struct sizer<group_join_it<Base, State>> : sizer<Base>
+    {};
+    template<typename First, typename Second>
+    struct sizer<concat_it<First, Second>>
+    {
+        static constexpr size_hint run(concat_it<First, Second> const &begin, concat_it<First, Second> const &end) noexcept(true) {
+            auto const first = sizer<First>::run(begin.first(), end.first());
+            auto const second = sizer<Second>::run(begin.second(), end.second());
+            auto const unknown = first.size == unknown_size || second.size == unknown_size;
+            return size_hint{unknown ? unknown_size : first.size + second.size, first.exact && second.exact};
+        }
+    };
+    template<typename State>
+    struct sizer<memo_it<State>>
+    {
+        static size_hint run(memo_it<State> const &begin, memo_it<State> const &end) {
+            auto const memo = begin.state().hint();
+            auto const last = std::min(end.index(), memo.size);
+            auto const first = std::min(begin.index(), last);
+            return size_hint{last == unknown_size ? unknown_size : last - first, memo.exact};
+        }
+    };
+    template<typename Base>
+    struct sizer<chunk_it<Base>>
+    {
+        static constexpr size_hint run(chunk_it<Base> const &begin, chunk_it<Base> const &end) noexcept(true) {
+            auto const rest = sizer<Base>::run(begin.base(), end.base());
+            if (rest.size == unknown_size)
+                return rest;
+            auto const held = begin.empty() ? 0 : 1;
+            return size_hint{held + (rest.size + begin.width() - 1) / begin.width(), rest.exact};
+        }
+    };
+    template<typename Base, typename In>
+    struct sizer<take_it<Base, In>>
+    {
+        static constexpr size_hint run(Base const &begin, Base const &end) noexcept(true) {
+            return size_hint{sizer<Base>::run(begin, end).size, false};
+        }
+    };
+    template<typename Base>
+    struct sizer<take_it<Base, int>>
+    {
+        static constexpr size_hint run(take_it<Base, int> const &begin, take_it<Base, int> const &end) noexcept(true) {
+            auto const base = sizer<Base>::run(begin, end);
+            auto const count = begin.remaining() - end.remaining();
+            auto const max = static_cast<std::size_t>(count > 0 ? count : 0);
+            return max < base.size ? size_hint{max, base.exact} : base;
+        }
+    };
+    template<typename Base>
+    struct sizer<std::reverse_iterator<Base>>
+    {
+        static constexpr size_hint run(std::reverse_iterator<Base> const &begin, std::reverse_iterator<Base> const &end) noexcept(true) {
+            return sizer<Base>::run(end.base(), begin.base());
+        }
+    };
+
+    template<typename It>
+    constexpr size_hint size_range(It const &begin, It const &end) noexcept(true) {
+        return sizer<It>::run(begin, end);
+    }
+
+    // push_back that never grows past the known upper bound of the input
+    template<typename Vector, typename Value>
+    void push_bounded(Vector &out, Value &&value, std::size_t const bound) {
+        if (out.size() == out.capacity())
+            out.reserve(std::max(out.size() + 1, std::min(bound, std::max<std::size_t>(out.capacity() * 2, 16))));
+        out.push_back(std::forward<Value>(value));
+    }
+
+    // appends a whole range: one exact reservation when the size is known, otherwise
+    // geometric growth capped by the upper bound
+    template<typename It, typename Vector>
+    void collect(It const &begin, It const &end, Vector &out) {
+        auto const hint = size_range(begin, end);
+        if (hint.exact)
+            out.reserve(out.size() + hint.size);
+        auto const bound = hint.size == unknown_size ? unknown_size : out.size() + hint.size;
+        push_range(begin, end, [&out, bound](auto &&it) {
+            push_bounded(out, std::forward<decltype(it)>(it), bound);
+            return true;
+        });
+    }
+}
+
+#endif // !SIZE_H_
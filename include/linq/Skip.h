@@ -0,0 +1,126 @@
+#ifndef SKIP_H_
+# define SKIP_H_
+
+namespace linq
+{
+    // moves a bound of Skip, SkipWhile or of a counted Take over a random-access range, given
+    // the opposite bound of the range
+    struct skip_seek
+    {
+        std::size_t count;
+
+        template<typename It>
+        constexpr void operator()(It &begin, It const &end) const noexcept(nothrow_range<It>::value) { begin = advance_bounded(begin, end, count); }
+    };
+    struct take_seek
+    {
+        std::size_t count;
+
+        template<typename It>
+        constexpr void operator()(It &end, It const &begin) const noexcept(nothrow_range<It>::value) { end = advance_bounded(begin, end, count); }
+    };
+    template<typename Key>
+    struct skip_while_seek
+    {
+        Key key;
+
+        template<typename It>
+        constexpr void operator()(It &begin, It const &end) const noexcept(nothrow_range<It>::value) {
+            while (begin != end && key(*begin))
+                ++begin;
+        }
+    };
+
+    // a bound left where the stage was built: it keeps the opposite bound and moves into
+    // place when it settles, so Skip and Take walk nothing before the first enumeration
+    template<typename Base, typename Seek>
+    class seek_it : public Base, private closure_ref<Seek, seek_it<Base, Seek>> {
+        using closure_t = closure_ref<Seek, seek_it<Base, Seek>>;
+    public:
+        typedef Base                             base;
+        typedef typename Base::iterator_category iterator_category;
+        typedef decltype(*std::declval<Base>())     value_type;
+        typedef typename Base::difference_type     difference_type;
+        typedef typename Base::pointer             pointer;
+        typedef value_type                          reference;
+
+        seek_it() = delete;
+        seek_it(seek_it const &) = default;
+        seek_it(Base const &base, closure_t const &seek) noexcept(true)
+                : Base(base), closure_t(seek), other_(base), pending_(false)
+        {}
+        seek_it(Base const &base, Base const &other, closure_t const &seek) noexcept(true)
+                : Base(base), closure_t(seek), other_(other), pending_(true)
+        {}
+
+        constexpr auto const &operator=(seek_it const &rhs) noexcept(true) {
+            static_cast<Base &>(*this) = static_cast<Base const &>(rhs);
+            other_ = rhs.other_;
+            pending_ = rhs.pending_;
+            return (*this);
+        }
+        constexpr auto const &operator++() noexcept(nothrow_range<Base>::value) {
+            static_cast<Base &>(*this).operator++();
+            return (*this);
+        }
+        constexpr auto operator++(int) noexcept(nothrow_range<Base>::value) {
+            auto tmp = *this;
+            operator++();
+            return (tmp);
+        }
+        constexpr auto const &operator--() noexcept(nothrow_range<Base>::value) {
+            static_cast<Base &>(*this).operator--();
+            return (*this);
+        }
+        constexpr auto operator--(int) noexcept(nothrow_range<Base>::value) {
+            auto tmp = *this;
+            operator--();
+            return (tmp);
+        }
+
+        constexpr auto const &operator+=(difference_type const n) noexcept(nothrow_range<Base>::value) {
+            static_cast<Base &>(*this) += n;
+            return (*this);
+        }
+        constexpr auto const &operator-=(difference_type const n) noexcept(nothrow_range<Base>::value) {
+            static_cast<Base &>(*this) -= n;
+            return (*this);
+        }
+        constexpr auto operator+(difference_type const n) const noexcept(nothrow_range<Base>::value) {
+            auto tmp = *this;
+            tmp += n;
+            return (tmp);
+        }
+        constexpr auto operator-(difference_type const n) const noexcept(nothrow_range<Base>::value) {
+            auto tmp = *this;
+            tmp -= n;
+            return (tmp);
+        }
+        constexpr difference_type operator-(seek_it const &rhs) const noexcept(nothrow_range<Base>::value) {
+            return static_cast<Base const &>(*this) - static_cast<Base const &>(rhs);
+        }
+        constexpr value_type operator[](difference_type const n) const noexcept(nothrow_range<Base>::value) {
+            return static_cast<Base const &>(*this)[n];
+        }
+        friend constexpr auto operator+(difference_type const n, seek_it const &rhs) noexcept(nothrow_range<Base>::value) {
+            return (rhs + n);
+        }
+
+        constexpr void settle() noexcept(nothrow_range<Base>::value) {
+            linq::settle(static_cast<Base &>(*this));
+            if (!pending_)
+                return;
+            linq::settle(other_);
+            closure_t::get()(static_cast<Base &>(*this), other_);
+            pending_ = false;
+        }
+
+        constexpr closure_t const &closure() const noexcept(true) { return *this; }
+
+    private:
+        Base other_;
+        bool pending_;
+    };
+}
+
+#endif // !SKIP_H_
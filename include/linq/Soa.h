@@ -0,0 +1,221 @@
+#ifndef SOA_H_
+# define SOA_H_
+
+namespace linq
+{
+    // columnar copy of the listed members of T, one contiguous vector per member, so that a
+    // query only reads the columns it names. Full rows are rebuilt on demand, members that
+    // are not stored keep their default value
+    template<typename T, typename... Ms>
+    class soa
+    {
+        template<typename M>
+        using is_stored_type = std::integral_constant<bool, !std::is_same<std::integer_sequence<bool, false, std::is_same<M, Ms>::value...>,
+                                                                          std::integer_sequence<bool, std::is_same<M, Ms>::value..., false>>::value>;
+    public:
+        typedef T row_type;
+
+        explicit soa(Ms T::*...members)
+                : members_(members...) {}
+        template<typename Container>
+        soa(Container const &rows, Ms T::*...members)
+                : members_(members...) {
+            reserve(rows.size());
+            for (auto const &row : rows)
+                push_back(row);
+        }
+
+        void reserve(std::size_t const size) {
+            reserve(size, std::index_sequence_for<Ms...>{});
+        }
+        void push_back(T const &row) {
+            push_back(row, std::index_sequence_for<Ms...>{});
+            ++size_;
+        }
+        std::size_t size() const noexcept(true) { return size_; }
+
+        // a member of a type no column has is a compile error, one of a stored type that was
+        // not listed is only known here
+        template<typename M>
+        std::vector<M> const &column(M T::*member) const {
+            static_assert(is_stored_type<M>::value, "linq::soa: no column of this member type is stored");
+            auto const found = find<0>(member);
+            if (!found)
+                throw std::out_of_range("linq::soa: member not stored");
+            return *found;
+        }
+        T row(std::size_t const index) const {
+            T ret{};
+            row(ret, index, std::index_sequence_for<Ms...>{});
+            return ret;
+        }
+
+    private:
+        template<std::size_t... I>
+        void reserve(std::size_t const size, std::index_sequence<I...>) {
+            (void) std::initializer_list<int>{(std::get<I>(columns_).reserve(size), 0)...};
+        }
+        template<std::size_t... I>
+        void push_back(T const &row, std::index_sequence<I...>) {
+            (void) std::initializer_list<int>{(std::get<I>(columns_).push_back(row.*std::get<I>(members_)), 0)...};
+        }
+        template<std::size_t... I>
+        void row(T &out, std::size_t const index, std::index_sequence<I...>) const {
+            (void) std::initializer_list<int>{(out.*std::get<I>(members_) = std::get<I>(columns_)[index], 0)...};
+        }
+
+        // the column of member among those of type M
+        template<std::size_t I, typename M>
+        typename std::enable_if<I == sizeof...(Ms), std::vector<M> const *>::type find(M T::*) const noexcept(true) {
+            return nullptr;
+        }
+        template<std::size_t I, typename M>
+        typename std::enable_if<I < sizeof...(Ms), std::vector<M> const *>::type find(M T::*member) const noexcept(true) {
+            auto const found = match<I>(member, std::is_same<M, typename std::tuple_element<I, std::tuple<Ms...>>::type>{});
+            return found ? found : find<I + 1>(member);
+        }
+        template<std::size_t I, typename M>
+        std::vector<M> const *match(M T::*member, std::true_type) const noexcept(true) {
+            return std::get<I>(members_) == member ? &std::get<I>(columns_) : nullptr;
+        }
+        template<std::size_t I, typename M>
+        std::vector<M> const *match(M T::*, std::false_type) const noexcept(true) {
+            return nullptr;
+        }
+
+        std::tuple<Ms T::*...> members_;
+        std::tuple<std::vector<Ms>...> columns_;
+        std::size_t size_ = 0;
+    };
+
+    template<typename Container, typename T, typename... Ms>
+    soa<T, Ms...> make_soa(Container const &rows, Ms T::*...members) {
+        return soa<T, Ms...>(rows, members...);
+    }
+
+    // what a columnar source yields: a row position, fields are read column by column
+    template<typename Soa>
+    class soa_row
+    {
+        using T = typename Soa::row_type;
+    public:
+        soa_row(Soa const &store, std::size_t const index) noexcept(true)
+                : store_(&store), index_(index) {}
+
+        template<typename M>
+        M const &operator[](M T::*member) const { return store_->column(member)[index_]; }
+        T get() const { return store_->row(index_); }
+        operator T() const { return get(); }
+
+        std::size_t index() const noexcept(true) { return index_; }
+
+    private:
+        Soa const *store_;
+        std::size_t index_;
+    };
+    template<typename M, typename T, typename... Ms>
+    M const &project(soa_row<soa<T, Ms...>> const &row, M T::*member) { return row[member]; }
+
+    template<typename Soa>
+    class soa_it
+    {
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef soa_row<Soa>                    value_type;
+        typedef std::ptrdiff_t                  difference_type;
+        typedef void                            pointer;
+        typedef value_type                      reference;
+
+        soa_it(Soa const &store, std::size_t const index) noexcept(true)
+                : store_(&store), index_(index) {}
+
+        constexpr value_type operator*() const noexcept(true) { return value_type(*store_, index_); }
+        constexpr value_type operator[](difference_type const n) const noexcept(true) { return value_type(*store_, index_ + n); }
+
+        constexpr auto &operator++() noexcept(true) { ++index_; return (*this); }
+        constexpr auto operator++(int) noexcept(true) { auto tmp = *this; ++index_; return (tmp); }
+        constexpr auto &operator--() noexcept(true) { --index_; return (*this); }
+        constexpr auto operator--(int) noexcept(true) { auto tmp = *this; --index_; return (tmp); }
+        constexpr auto &operator+=(difference_type const n) noexcept(true) { index_ += n; return (*this); }
+        constexpr auto &operator-=(difference_type const n) noexcept(true) { index_ -= n; return (*this); }
+        constexpr auto operator+(difference_type const n) const noexcept(true) { return soa_it(*store_, index_ + n); }
+        constexpr auto operator-(difference_type const n) const noexcept(true) { return soa_it(*store_, index_ - n); }
+        constexpr difference_type operator-(soa_it const &rhs) const noexcept(true) {
+            return static_cast<difference_type>(index_) - static_cast<difference_type>(rhs.index_);
+        }
+        friend constexpr auto operator+(difference_type const n, soa_it const &rhs) noexcept(true) { return (rhs + n); }
+
+        constexpr bool operator==(soa_it const &rhs) const noexcept(true) { return index_ == rhs.index_; }
+        constexpr bool operator!=(soa_it const &rhs) const noexcept(true) { return index_ != rhs.index_; }
+        constexpr bool operator<(soa_it const &rhs) const noexcept(true) { return index_ < rhs.index_; }
+        constexpr bool operator>(soa_it const &rhs) const noexcept(true) { return index_ > rhs.index_; }
+        constexpr bool operator<=(soa_it const &rhs) const noexcept(true) { return index_ <= rhs.index_; }
+        constexpr bool operator>=(soa_it const &rhs) const noexcept(true) { return index_ >= rhs.index_; }
+
+        constexpr Soa const &store() const noexcept(true) { return *store_; }
+        constexpr std::size_t index() const noexcept(true) { return index_; }
+
+    private:
+        Soa const *store_;
+        std::size_t index_;
+    };
+
+    // Select(&T::member) straight over a columnar source is the column itself: a contiguous
+    // range the SIMD kernels of Reduce.h scan directly
+    template<typename It, typename Func>
+    struct is_column : std::false_type {};
+    template<typename T, typename... Ms, typename M>
+    struct is_column<basic_it<soa_it<soa<T, Ms...>>>, M T::*>
+            : std::integral_constant<bool, !std::is_function<M>::value> {};
+
+    // member pointer keys of the stages over the rows of a columnar source (Where(&T::flag),
+    // GroupBy(&T::group)...) are bound to their column once, when the stage is built
+    template<typename M>
+    struct column_of
+    {
+        M const *data;
+
+        template<typename Soa>
+        constexpr M const &operator()(soa_row<Soa> const &row) const noexcept(true) { return data[row.index()]; }
+    };
+
+    template<typename It, typename Row = typename std::decay<decltype(*std::declval<It>())>::type>
+    struct soa_rows : std::false_type {};
+    template<typename It, typename Soa>
+    struct soa_rows<It, soa_row<Soa>> : std::is_base_of<soa_it<Soa>, It>
+    {
+        typedef Soa store_type;
+    };
+
+    template<typename It, typename Func, typename = void>
+    struct column_key
+    {
+        typedef callable_t<Func> type;
+
+        static constexpr decltype(auto) bind(It const &, Func const &func) noexcept(true) { return as_callable(func); }
+    };
+    template<typename It, typename M, typename T>
+    struct column_key<It, M T::*, typename std::enable_if<soa_rows<It>::value && !std::is_function<M>::value &&
+                                                          std::is_same<T, typename soa_rows<It>::store_type::row_type>::value>::type>
+    {
+        typedef column_of<M> type;
+
+        static type bind(It const &begin, M T::*member) {
+            using store_t = typename soa_rows<It>::store_type;
+            return type{static_cast<soa_it<store_t> const &>(begin).store().column(member).data()};
+        }
+    };
+    template<typename It, typename Func>
+    using column_key_t = typename column_key<It, Func>::type;
+    template<typename It, typename Func>
+    constexpr decltype(auto) bind_key(It const &begin, Func const &func) { return column_key<It, Func>::bind(begin, func); }
+
+    template<typename Soa, typename M, typename T>
+    auto column_range(soa_it<Soa> const &begin, soa_it<Soa> const &end, M T::*member) {
+        auto const &column = begin.store().column(member);
+        return std::make_pair(column.begin() + static_cast<std::ptrdiff_t>(begin.index()),
+                              column.begin() + static_cast<std::ptrdiff_t>(end.index()));
+    }
+}
+
+#endif // !SOA_H_
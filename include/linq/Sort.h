@@ -0,0 +1,393 @@
+#ifndef SORT_H_
+# define SORT_H_
+
+namespace linq
+{
+    constexpr std::size_t radix_sort_threshold = 64;
+    constexpr std::size_t parallel_sort_threshold = 1 << 16;
+
+    namespace detail
+    {
+        template<std::size_t Size>
+        struct radix_word;
+        template<>
+        struct radix_word<1> { typedef std::uint8_t type; };
+        template<>
+        struct radix_word<2> { typedef std::uint16_t type; };
+        template<>
+        struct radix_word<4> { typedef std::uint32_t type; };
+        template<>
+        struct radix_word<8> { typedef std::uint64_t type; };
+
+        // maps an arithmetic key onto an unsigned word with the same ordering. -0.0 maps with
+        // +0.0, as they compare equal, and every NaN onto one word after +inf
+        template<typename Key>
+        struct radix_encode
+        {
+            typedef typename radix_word<sizeof(Key)>::type word;
+            static constexpr word sign = static_cast<word>(word(1) << (sizeof(word) * 8 - 1));
+
+            static word run(Key const key) noexcept(true) {
+                return run(key, std::is_floating_point<Key>{}, std::is_signed<Key>{});
+            }
+
+        private:
+            static word run(Key const key, std::false_type, std::false_type) noexcept(true) {
+                return static_cast<word>(key);
+            }
+            static word run(Key const key, std::false_type, std::true_type) noexcept(true) {
+                return static_cast<word>(static_cast<word>(key) ^ sign);
+            }
+            static word run(Key const key, std::true_type, std::true_type) noexcept(true) {
+                if (key != key)
+                    return static_cast<word>(~word(0));
+                Key const folded = key == Key{} ? Key{} : key;
+                word bits;
+                std::memcpy(&bits, &folded, sizeof(bits));
+                return static_cast<word>(bits & sign ? ~bits : bits | sign);
+            }
+        };
+
+        template<typename Filter>
+        struct radix_order : std::false_type {};
+        template<typename Key>
+        struct radix_order<Filter<TFilter<eOrderType::asc>, Key>> : std::true_type
+        {
+            static constexpr bool desc = false;
+        };
+        template<typename Key>
+        struct radix_order<Filter<TFilter<eOrderType::desc>, Key>> : std::true_type
+        {
+            static constexpr bool desc = true;
+        };
+
+        template<typename Filter, typename T>
+        using sort_key_t = typename std::decay<decltype(std::declval<Filter const &>().key(std::declval<row_value_t<T> const &>()))>::type;
+
+        // the radix word of a row under a lone asc/desc, complemented for desc
+        template<typename T, typename Filter>
+        typename radix_encode<sort_key_t<Filter, T>>::word radix_word_of(Filter const &filter, T const &item) {
+            using word = typename radix_encode<sort_key_t<Filter, T>>::word;
+            auto const key = radix_encode<sort_key_t<Filter, T>>::run(filter.key(row_value(item)));
+            return radix_order<Filter>::desc ? static_cast<word>(~key) : key;
+        }
+
+        // a lone asc/desc over an integral or floating key is radix sorted
+        template<typename T, typename Filter, typename = void>
+        struct radix_key : std::false_type {};
+        template<typename T, typename Filter>
+        struct radix_key<T, Filter, typename std::enable_if<radix_order<Filter>::value
+                                                            && std::is_arithmetic<sort_key_t<Filter, T>>::value
+                                                            && !std::is_same<sort_key_t<Filter, T>, bool>::value>::type>
+                : std::true_type {};
+
+        template<std::size_t I, std::size_t N>
+        struct key_order
+        {
+            template<typename Filters, typename Keys>
+            static constexpr bool before(Filters const &filters, Keys const &a, Keys const &b, bool const tie) noexcept(true) {
+                auto const &filter = std::get<I>(filters);
+                return filter.before(std::get<I>(a), std::get<I>(b))
+                       || (filter.tied(std::get<I>(a), std::get<I>(b)) && key_order<I + 1, N>::before(filters, a, b, tie));
+            }
+        };
+        template<std::size_t N>
+        struct key_order<N, N>
+        {
+            template<typename Filters, typename Keys>
+            static constexpr bool before(Filters const &, Keys const &, Keys const &, bool const tie) noexcept(true) {
+                return tie;
+            }
+        };
+
+        // moves items so that items[i] becomes the former items[perm[i]], following each cycle once
+        template<typename Vector>
+        void permute(Vector &items, std::vector<std::size_t> &perm) {
+            using T = typename Vector::value_type;
+            for (std::size_t i = 0; i < perm.size(); ++i) {
+                if (perm[i] == i)
+                    continue;
+                T tmp = std::move(items[i]);
+                auto j = i;
+                while (perm[j] != i) {
+                    auto const next = perm[j];
+                    items[j] = std::move(items[next]);
+                    perm[j] = j;
+                    j = next;
+                }
+                items[j] = std::move(tmp);
+                perm[j] = j;
+            }
+        }
+
+        template<typename T, typename Alloc, typename Filter>
+        void sort_by(std::vector<T, Alloc> &items, std::true_type, Filter const &filter) {
+            using word = typename radix_encode<sort_key_t<Filter, T>>::word;
+            struct entry { word key; std::size_t index; };
+            constexpr std::size_t passes = sizeof(word);
+            constexpr std::size_t radix = 256;
+
+            auto const size = items.size();
+            std::vector<entry> from(size);
+            for (std::size_t i = 0; i < size; ++i)
+                from[i] = entry{radix_word_of(filter, items[i]), i};
+
+            // few rows are compared by the same words, so their order does not depend on the count
+            if (size < radix_sort_threshold) {
+                std::sort(from.begin(), from.end(), [](entry const &a, entry const &b) {
+                    return a.key < b.key || (a.key == b.key && a.index < b.index);
+                });
+            } else {
+                std::vector<entry> to(size);
+                std::vector<std::size_t> counts(passes * radix, 0);
+                for (auto const &e : from)
+                    for (std::size_t pass = 0; pass < passes; ++pass)
+                        ++counts[pass * radix + ((e.key >> (pass * 8)) & 0xff)];
+
+                for (std::size_t pass = 0; pass < passes; ++pass) {
+                    auto const count = counts.begin() + static_cast<std::ptrdiff_t>(pass * radix);
+                    if (count[(from[0].key >> (pass * 8)) & 0xff] == size)
+                        continue;
+                    std::size_t offset = 0;
+                    for (std::size_t digit = 0; digit < radix; ++digit) {
+                        auto const n = count[digit];
+                        count[digit] = offset;
+                        offset += n;
+                    }
+                    for (auto const &e : from)
+                        to[count[(e.key >> (pass * 8)) & 0xff]++] = e;
+                    from.swap(to);
+                }
+            }
+
+            std::vector<std::size_t> perm(size);
+            for (std::size_t i = 0; i < size; ++i)
+                perm[i] = from[i].index;
+            permute(items, perm);
+        }
+
+        template<typename T, typename Alloc, typename... Filters>
+        void sort_by(std::vector<T, Alloc> &items, std::false_type, Filters const &...filters) {
+            using entry = std::pair<std::tuple<sort_key_t<Filters, T>...>, std::size_t>;
+            std::vector<entry> entries;
+            entries.reserve(items.size());
+            for (auto const &item : items)
+                entries.emplace_back(std::make_tuple(filters.key(row_value(item))...), entries.size());
+
+            auto const order = std::forward_as_tuple(filters...);
+            std::sort(entries.begin(), entries.end(), [&order](entry const &a, entry const &b) {
+                return key_order<0, sizeof...(Filters)>::before(order, a.first, b.first, a.second < b.second);
+            });
+
+            std::vector<std::size_t> perm(entries.size());
+            for (std::size_t i = 0; i < entries.size(); ++i)
+                perm[i] = entries[i].second;
+            permute(items, perm);
+        }
+    }
+
+    // stable multi-key sort: keys are extracted once per element and a permutation
+    // is sorted in their place, so each record only moves once at the end
+    template<typename T, typename Alloc, typename... Filters>
+    void sort_by(std::vector<T, Alloc> &items, Filters const &...filters) {
+        if (items.size() < 2)
+            return;
+        detail::sort_by(items, std::false_type{}, filters...);
+    }
+    template<typename T, typename Alloc, typename Filter>
+    void sort_by(std::vector<T, Alloc> &items, Filter const &filter) {
+        if (items.size() < 2)
+            return;
+        if (detail::radix_key<T, Filter>::value)
+            detail::sort_by(items, detail::radix_key<T, Filter>{}, filter);
+        else
+            detail::sort_by(items, std::false_type{}, filter);
+    }
+
+    namespace detail
+    {
+        // sample sort over a strict total order: buckets are cut at splitters picked from an
+        // evenly spaced sample, every slice of the input is scattered into them at offsets
+        // counted beforehand, then the buckets are sorted independently
+        template<typename Entry, typename Less>
+        void sample_sort(std::vector<Entry> &items, Less const &less, thread_pool &pool, std::size_t const parts) {
+            constexpr std::size_t oversample = 32;
+            auto const size = items.size();
+            auto const slice = [size, parts](std::size_t const part) { return size * part / parts; };
+
+            std::vector<Entry> sample;
+            sample.reserve(parts * oversample);
+            for (std::size_t i = 0; i < parts * oversample; ++i)
+                sample.push_back(items[size * i / (parts * oversample)]);
+            std::sort(sample.begin(), sample.end(), less);
+            std::vector<Entry> pivots;
+            pivots.reserve(parts - 1);
+            for (std::size_t bucket = 1; bucket < parts; ++bucket)
+                pivots.push_back(sample[bucket * oversample]);
+            auto const bucket_of = [&pivots, &less](Entry const &entry) {
+                return static_cast<std::size_t>(std::upper_bound(pivots.begin(), pivots.end(), entry, less) - pivots.begin());
+            };
+
+            // counts[part * parts + bucket], then the offset where that part writes into that bucket
+            std::vector<std::size_t> counts(parts * parts, 0);
+            pool.run(parts, [&](std::size_t const part) {
+                for (auto i = slice(part); i < slice(part + 1); ++i)
+                    ++counts[part * parts + bucket_of(items[i])];
+            });
+            std::vector<std::size_t> starts(parts + 1, size);
+            std::size_t offset = 0;
+            for (std::size_t bucket = 0; bucket < parts; ++bucket) {
+                starts[bucket] = offset;
+                for (std::size_t part = 0; part < parts; ++part) {
+                    auto const n = counts[part * parts + bucket];
+                    counts[part * parts + bucket] = offset;
+                    offset += n;
+                }
+            }
+
+            std::vector<Entry> out(size);
+            pool.run(parts, [&](std::size_t const part) {
+                auto cursor = counts.begin() + static_cast<std::ptrdiff_t>(part * parts);
+                for (auto i = slice(part); i < slice(part + 1); ++i)
+                    out[cursor[static_cast<std::ptrdiff_t>(bucket_of(items[i]))]++] = std::move(items[i]);
+            });
+            pool.run(parts, [&](std::size_t const bucket) {
+                std::sort(out.begin() + static_cast<std::ptrdiff_t>(starts[bucket]),
+                          out.begin() + static_cast<std::ptrdiff_t>(starts[bucket + 1]), less);
+            });
+            items.swap(out);
+        }
+
+        // rows are gathered in sorted order in parallel when a sorted copy can be default
+        // built, otherwise permuted in place
+        template<typename T, typename Alloc, typename Entries>
+        void gather(std::vector<T, Alloc> &items, Entries const &entries, thread_pool &pool, std::size_t const parts, std::true_type) {
+            auto const size = items.size();
+            std::vector<T, Alloc> sorted(size, items.get_allocator());
+            pool.run(parts, [&](std::size_t const part) {
+                for (auto i = size * part / parts; i < size * (part + 1) / parts; ++i)
+                    sorted[i] = std::move(items[entries[i].second]);
+            });
+            items.swap(sorted);
+        }
+        template<typename T, typename Alloc, typename Entries>
+        void gather(std::vector<T, Alloc> &items, Entries const &entries, thread_pool &, std::size_t const, std::false_type) {
+            std::vector<std::size_t> perm(entries.size());
+            for (std::size_t i = 0; i < entries.size(); ++i)
+                perm[i] = entries[i].second;
+            permute(items, perm);
+        }
+
+        template<typename T, typename Alloc, typename... Filters>
+        void parallel_sort_by(std::vector<T, Alloc> &items, thread_pool &pool, std::size_t const threads, std::true_type,
+                              Filters const &...filters) {
+            using entry = std::pair<std::tuple<sort_key_t<Filters, T>...>, std::size_t>;
+            auto const size = items.size();
+            auto const parts = threads * 4;
+            std::vector<entry> entries(size);
+            pool.run(parts, [&](std::size_t const part) {
+                for (auto i = size * part / parts; i < size * (part + 1) / parts; ++i)
+                    entries[i] = entry(std::make_tuple(filters.key(row_value(items[i]))...), i);
+            });
+
+            auto const order = std::forward_as_tuple(filters...);
+            sample_sort(entries, [&order](entry const &a, entry const &b) {
+                return key_order<0, sizeof...(Filters)>::before(order, a.first, b.first, a.second < b.second);
+            }, pool, parts);
+            gather(items, entries, pool, parts, std::is_default_constructible<T>{});
+        }
+        template<typename T, typename Alloc, typename... Filters>
+        void parallel_sort_by(std::vector<T, Alloc> &items, thread_pool &, std::size_t const, std::false_type,
+                              Filters const &...filters) {
+            linq::sort_by(items, filters...);
+        }
+
+        // a lone radix key is compared by its radix word, so that the pool orders signed
+        // zeros and NaNs as the sequential radix sort does
+        template<typename T, typename Alloc, typename Filter>
+        void parallel_radix_sort_by(std::vector<T, Alloc> &items, thread_pool &pool, std::size_t const threads, std::true_type,
+                                    Filter const &filter) {
+            using entry = std::pair<typename radix_encode<sort_key_t<Filter, T>>::word, std::size_t>;
+            auto const size = items.size();
+            auto const parts = threads * 4;
+            std::vector<entry> entries(size);
+            pool.run(parts, [&](std::size_t const part) {
+                for (auto i = size * part / parts; i < size * (part + 1) / parts; ++i)
+                    entries[i] = entry(radix_word_of(filter, items[i]), i);
+            });
+
+            sample_sort(entries, std::less<entry>(), pool, parts);
+            gather(items, entries, pool, parts, std::is_default_constructible<T>{});
+        }
+        template<typename T, typename Alloc, typename Filter>
+        void parallel_radix_sort_by(std::vector<T, Alloc> &items, thread_pool &pool, std::size_t const threads, std::false_type,
+                                    Filter const &filter) {
+            using entry = std::pair<std::tuple<sort_key_t<Filter, T>>, std::size_t>;
+            detail::parallel_sort_by(items, pool, threads, std::is_default_constructible<entry>{}, filter);
+        }
+    }
+
+    // sort_by on the pool: the same entries and order (a lone radix key by its radix word),
+    // so the same (stable) result. Small inputs, and keys that cannot be default built, take
+    // the sequential path
+    template<typename T, typename Alloc, typename... Filters>
+    void parallel_sort_by(std::vector<T, Alloc> &items, thread_pool &pool, std::size_t const threads, Filters const &...filters) {
+        using entry = std::pair<std::tuple<detail::sort_key_t<Filters, T>...>, std::size_t>;
+        if (threads < 2 || items.size() < parallel_sort_threshold)
+            sort_by(items, filters...);
+        else
+            detail::parallel_sort_by(items, pool, threads, std::is_default_constructible<entry>{}, filters...);
+    }
+    template<typename T, typename Alloc, typename Filter>
+    void parallel_sort_by(std::vector<T, Alloc> &items, thread_pool &pool, std::size_t const threads, Filter const &filter) {
+        if (threads < 2 || items.size() < parallel_sort_threshold)
+            sort_by(items, filter);
+        else
+            detail::parallel_radix_sort_by(items, pool, threads, detail::radix_key<T, Filter>{}, filter);
+    }
+
+    // bounded heap over the first `limit` elements in sort_by order, so only those are ever
+    // kept; index ties make it agree with the full stable sort
+    template<typename It, typename T, typename Alloc, typename... Filters>
+    void top_by(It const &begin, It const &end, std::size_t const limit, std::vector<T, Alloc> &out, Filters const &...filters) {
+        using keys_t = std::tuple<detail::sort_key_t<Filters, T>...>;
+        struct entry { keys_t keys; std::size_t index; std::size_t slot; };
+
+        out.clear();
+        if (!limit)
+            return;
+        auto const order = std::forward_as_tuple(filters...);
+        auto const before = [&order](entry const &a, entry const &b) {
+            return detail::key_order<0, sizeof...(Filters)>::before(order, a.keys, b.keys, a.index < b.index);
+        };
+        std::vector<entry> heap;
+        auto const hint = size_range(begin, end);
+        heap.reserve(std::min(limit, hint.exact ? hint.size : std::min<std::size_t>(hint.size, 4096)));
+        out.reserve(heap.capacity());
+
+        std::size_t index = 0;
+        push_range(begin, end, [&](auto &&it) {
+            entry next{keys_t(filters.key(it)...), index++, heap.size()};
+            if (heap.size() < limit) {
+                out.push_back(it);
+                heap.push_back(std::move(next));
+                std::push_heap(heap.begin(), heap.end(), before);
+            } else if (before(next, heap.front())) {
+                std::pop_heap(heap.begin(), heap.end(), before);
+                next.slot = heap.back().slot;
+                out[next.slot] = it;
+                heap.back() = std::move(next);
+                std::push_heap(heap.begin(), heap.end(), before);
+            }
+            return true;
+        });
+
+        std::sort_heap(heap.begin(), heap.end(), before);
+        std::vector<std::size_t> perm(heap.size());
+        for (std::size_t i = 0; i < heap.size(); ++i)
+            perm[i] = heap[i].slot;
+        detail::permute(out, perm);
+    }
+}
+
+#endif // !SORT_H_
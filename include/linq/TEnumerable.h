@@ -9,6 +9,10 @@ namespace linq
         typedef typename Handle::iterator iterator_type;
         typedef decltype(*std::declval<iterator_type>()) out_t;
 
+        // Concat reads the unsettled bounds of the handle it appends
+        template<typename>
+        friend class TState;
+
     public:
         TEnumerable() = delete;
         ~TEnumerable() = default;
@@ -19,33 +23,40 @@ namespace linq
                 : Handle(rhs)
         {}
 
-        constexpr const iterator_type &begin() const noexcept(true) {
+        constexpr decltype(auto) begin() const noexcept(noexcept(std::declval<Handle const &>().begin())) {
             return static_cast<Handle const &>(*this).begin();
         }
-        constexpr const iterator_type &end() const noexcept(true) {
+        constexpr decltype(auto) end() const noexcept(noexcept(std::declval<Handle const &>().end())) {
             return static_cast<Handle const &>(*this).end();
         }
 
-        constexpr out_t First() const noexcept(true) {
+        constexpr decltype(auto) First() const noexcept(noexcept(std::declval<Handle const &>().first())) {
             return static_cast<Handle const &>(*this).first();
         }
-        constexpr auto FirstOrDefault() const noexcept(true) {
+        constexpr auto FirstOrDefault() const noexcept(noexcept(std::declval<Handle const &>().firstOrDefault())) {
             return static_cast<Handle const &>(*this).firstOrDefault();
         }
 
-        constexpr out_t Last() const noexcept(true) {
+        constexpr decltype(auto) Last() const noexcept(noexcept(std::declval<Handle const &>().last())) {
             return static_cast<Handle const &>(*this).last();
         }
-        constexpr auto LastOrDefault() const noexcept(true) {
+        constexpr auto LastOrDefault() const noexcept(noexcept(std::declval<Handle const &>().lastOrDefault())) {
             return static_cast<Handle const &>(*this).lastOrDefault();
         }
 
+        constexpr decltype(auto) ElementAt(std::size_t const index) const noexcept(noexcept(std::declval<Handle const &>().elementAt(index))) {
+            return static_cast<Handle const &>(*this).elementAt(index);
+        }
+        constexpr auto ElementAtOrDefault(std::size_t const index) const noexcept(noexcept(std::declval<Handle const &>().elementAtOrDefault(index))) {
+            return static_cast<Handle const &>(*this).elementAtOrDefault(index);
+        }
+
         constexpr auto Reverse() const noexcept(true) {
             using ret_t = TEnumerable<decltype(static_cast<Handle const &>(*this).reverse())>;
             return ret_t(static_cast<Handle const &>(*this).reverse());
         }
         template<typename Func>
-        constexpr auto Select(Func const &nextloader_) const noexcept(true) {
+        constexpr auto Select(Func const &nextloader_) const {
             using ret_t = TEnumerable<decltype(static_cast<Handle const &>(*this).select(nextloader_))>;
             return ret_t(static_cast<Handle const &>(*this).select(nextloader_));
         }
@@ -56,16 +67,21 @@ namespace linq
         }
 
         template<typename Func>
-        constexpr auto Where(Func const &nextfilter_) const noexcept(true) {
+        constexpr auto Where(Func const &nextfilter_) const {
             using ret_t = TEnumerable<decltype(static_cast<Handle const &>(*this).where(nextfilter_))>;
             return ret_t(static_cast<Handle const &>(*this).where(nextfilter_));
         }
         template<typename... Funcs>
 
-        constexpr auto GroupBy(Funcs const &...keys) const noexcept(true) {
+        constexpr auto GroupBy(Funcs const &...keys) const {
             using ret_t = TEnumerable<decltype(static_cast<Handle const &>(*this).groupBy(keys...))>;
             return ret_t(static_cast<Handle const &>(*this).groupBy(keys...));
         }
+        template<typename Seed, typename Func, typename std::enable_if<!is_aggregate<Seed>::value, int>::type = 0>
+        constexpr auto Aggregate(Seed const &seed, Func const &fold) const noexcept(true) {
+            using ret_t = TEnumerable<decltype(static_cast<Handle const &>(*this).aggregate(seed, fold))>;
+            return ret_t(static_cast<Handle const &>(*this).aggregate(seed, fold));
+        }
         template<typename... Funcs>
 
         constexpr auto OrderBy(Funcs const &...keys) const noexcept(true) {
@@ -81,12 +97,60 @@ namespace linq
             return ret_t(static_cast<Handle const &>(*this).desc());
         }
 
+        constexpr auto Distinct() const noexcept(true) {
+            using ret_t = TEnumerable<decltype(static_cast<Handle const &>(*this).distinct())>;
+            return ret_t(static_cast<Handle const &>(*this).distinct());
+        }
+        template<typename Func>
+        constexpr auto DistinctBy(Func const &key) const {
+            using ret_t = TEnumerable<decltype(static_cast<Handle const &>(*this).distinctBy(key))>;
+            return ret_t(static_cast<Handle const &>(*this).distinctBy(key));
+        }
+        constexpr auto Memoize() const noexcept(true) {
+            using ret_t = TEnumerable<decltype(static_cast<Handle const &>(*this).memoize())>;
+            return ret_t(static_cast<Handle const &>(*this).memoize());
+        }
+        template<typename Other>
+        constexpr auto Union(Other const &other) const noexcept(true) {
+            using ret_t = TEnumerable<decltype(static_cast<Handle const &>(*this).unionWith(other))>;
+            return ret_t(static_cast<Handle const &>(*this).unionWith(other));
+        }
+        template<typename Other>
+        constexpr auto Intersect(Other const &other) const noexcept(true) {
+            using ret_t = TEnumerable<decltype(static_cast<Handle const &>(*this).intersect(other))>;
+            return ret_t(static_cast<Handle const &>(*this).intersect(other));
+        }
+        template<typename Other>
+        constexpr auto Except(Other const &other) const noexcept(true) {
+            using ret_t = TEnumerable<decltype(static_cast<Handle const &>(*this).except(other))>;
+            return ret_t(static_cast<Handle const &>(*this).except(other));
+        }
+
+        template<typename Inner, typename OuterKey, typename InnerKey, typename Func>
+        constexpr auto Join(Inner const &inner, OuterKey const &outerKey, InnerKey const &innerKey,
+                            Func const &result) const {
+            using ret_t = TEnumerable<decltype(static_cast<Handle const &>(*this).join(inner, outerKey, innerKey, result))>;
+            return ret_t(static_cast<Handle const &>(*this).join(inner, outerKey, innerKey, result));
+        }
+        template<typename Inner, typename OuterKey, typename InnerKey, typename Func>
+        constexpr auto GroupJoin(Inner const &inner, OuterKey const &outerKey, InnerKey const &innerKey,
+                                 Func const &result) const {
+            using ret_t = TEnumerable<decltype(static_cast<Handle const &>(*this).groupJoin(inner, outerKey, innerKey, result))>;
+            return ret_t(static_cast<Handle const &>(*this).groupJoin(inner, outerKey, innerKey, result));
+        }
+
+        template<typename Other>
+        constexpr auto Concat(Other const &other) const noexcept(true) {
+            using ret_t = TEnumerable<decltype(static_cast<Handle const &>(*this).concat(other))>;
+            return ret_t(static_cast<Handle const &>(*this).concat(other));
+        }
+
         constexpr auto Skip(std::size_t const offset) const noexcept(true) {
             using ret_t = TEnumerable<decltype(static_cast<Handle const &>(*this).skip(offset))>;
             return ret_t(static_cast<Handle const &>(*this).skip(offset));
         }
         template<typename Func>
-        constexpr auto SkipWhile(Func const &func) const noexcept(true) {
+        constexpr auto SkipWhile(Func const &func) const {
             using ret_t = TEnumerable<decltype(static_cast<Handle const &>(*this).skip_while(func))>;
             return ret_t(static_cast<Handle const &>(*this).skip_while(func));
         }
@@ -96,25 +160,30 @@ namespace linq
             return ret_t(static_cast<Handle const &>(*this).take(limit));
         }
         template<typename Func>
-        constexpr auto TakeWhile(Func const &func) const noexcept(true) {
+        constexpr auto TakeWhile(Func const &func) const {
             using ret_t = TEnumerable<decltype(static_cast<Handle const &>(*this).take_while(func))>;
             return ret_t(static_cast<Handle const &>(*this).take_while(func));
         }
 
+        constexpr auto Chunk(std::size_t const size) const noexcept(true) {
+            using ret_t = TEnumerable<decltype(static_cast<Handle const &>(*this).chunk(size))>;
+            return ret_t(static_cast<Handle const &>(*this).chunk(size));
+        }
+
         template<typename Func>
-        constexpr auto &Each(Func const &pred) const noexcept(true) {
+        constexpr auto &Each(Func const &pred) const noexcept(noexcept(std::declval<Handle const &>().each(pred))) {
             static_cast<Handle const &>(*this).each(pred);
             return *this;
         }
 
         template<typename T>
-        constexpr bool Contains(T const &elem) const noexcept(true) {
+        constexpr bool Contains(T const &elem) const noexcept(noexcept(std::declval<Handle const &>().contains(elem))) {
             return static_cast<Handle const &>(*this).contains(elem);
         }
-        constexpr bool Any() const noexcept(true) {
+        constexpr bool Any() const noexcept(noexcept(std::declval<Handle const &>().any())) {
             return static_cast<Handle const &>(*this).any();
         }
-        constexpr auto Count() const noexcept(true) {
+        constexpr auto Count() const noexcept(noexcept(std::declval<Handle const &>().count())) {
             return static_cast<Handle const &>(*this).count();
         }
 
@@ -122,13 +191,38 @@ namespace linq
             using ret_t = TEnumerable<decltype(static_cast<Handle const &>(*this).all())>;
             return ret_t(static_cast<Handle const &>(*this).all());
         }
-        constexpr auto Min() const noexcept(true) {
+        template<typename Arg, typename... Args>
+        constexpr auto All(Arg const &arg, Args const &...args) const noexcept(true) {
+            using ret_t = TEnumerable<decltype(static_cast<Handle const &>(*this).all(arg, args...))>;
+            return ret_t(static_cast<Handle const &>(*this).all(arg, args...));
+        }
+        constexpr auto AsParallel(std::size_t const threads = 0) const noexcept(true) {
+            using ret_t = TEnumerable<decltype(static_cast<Handle const &>(*this).asParallel(threads))>;
+            return ret_t(static_cast<Handle const &>(*this).asParallel(threads));
+        }
+        constexpr auto AsSequential() const noexcept(true) {
+            using ret_t = TEnumerable<decltype(static_cast<Handle const &>(*this).asSequential())>;
+            return ret_t(static_cast<Handle const &>(*this).asSequential());
+        }
+        constexpr auto Prefetch(std::size_t const capacity) const noexcept(true) {
+            using ret_t = TEnumerable<decltype(static_cast<Handle const &>(*this).prefetch(capacity))>;
+            return ret_t(static_cast<Handle const &>(*this).prefetch(capacity));
+        }
+        constexpr auto AsPipelined() const noexcept(true) {
+            return Prefetch(1024);
+        }
+
+        constexpr auto Min() const noexcept(noexcept(std::declval<Handle const &>().min())) {
             return static_cast<Handle const &>(*this).min();
         }
-        constexpr auto Max() const noexcept(true) {
+        constexpr auto Max() const noexcept(noexcept(std::declval<Handle const &>().max())) {
             return static_cast<Handle const &>(*this).max();
         }
-        constexpr auto Sum() const noexcept(true) {
+        template<typename... Tags, typename std::enable_if<all_aggregates<Tags...>::value, int>::type = 0>
+        constexpr auto Aggregate(Tags const &...tags) const noexcept(noexcept(std::declval<Handle const &>().reduce(tags...))) {
+            return static_cast<Handle const &>(*this).reduce(tags...);
+        }
+        constexpr auto Sum() const noexcept(noexcept(std::declval<Handle const &>().sum())) {
             return static_cast<Handle const &>(*this).sum();
         }
 
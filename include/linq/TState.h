@@ -7,163 +7,384 @@ namespace linq
     class TState
     {
         using Out = typename Iterator::value_type;
+        using category = typename std::iterator_traits<Iterator>::iterator_category;
+        // rows of single-pass ranges live in the iterator and are overwritten by the next one,
+        // so the stages storing rows keep pointers to them only for forward ranges
+        using stable = std::is_base_of<std::forward_iterator_tag, category>;
+        using restarts = through_pipe<Iterator>;
     protected:
-        Iterator const begin_;
-        Iterator const end_;
+        // the bounds as built, left unsettled by the lazy stages: the stages after this one
+        // start from them
+        Iterator begin_;
+        Iterator end_;
+        // settled copies of them, made once by the first begin()/end(), whichever thread calls
+        // it: handles are shared between threads. Settling a range read through Prefetch may
+        // already start its pipeline, so every begin() of one returns a freshly settled copy
+        // and each enumeration runs its own pipeline
+        mutable Iterator first_;
+        mutable Iterator last_;
+        mutable std::atomic<bool> settled_;
+        mutable std::mutex settling_;
+        // keeps the closures the iterators point to alive
+        stage_context context_;
+
+        constexpr void settle() const noexcept(nothrow_range<Iterator>::value) {
+            if (settled_.load(std::memory_order_acquire))
+                return;
+            std::lock_guard<std::mutex> lock(settling_);
+            if (settled_.load(std::memory_order_relaxed))
+                return;
+            if (!restarts::value)
+                linq::settle(first_);
+            linq::settle(last_);
+            settled_.store(true, std::memory_order_release);
+        }
 
     public:
         ~TState() = default;
         TState() = delete;
-        TState(TState const &rhs) = default;
-        TState(Iterator const &&begin, Iterator const &&end)
-                : begin_(begin), end_(end) {}
+        TState(TState const &rhs)
+                : TState(rhs, rhs.settled_.load(std::memory_order_acquire)) {}
+        TState(Iterator const &&begin, Iterator const &&end, stage_context const &context = nullptr)
+                : begin_(begin), end_(end), first_(begin), last_(end), settled_(false), context_(context) {}
 
-        constexpr Iterator const &begin() const noexcept(true) { return begin_; }
-        constexpr Iterator const &end() const noexcept(true) { return end_; }
-        constexpr auto rbegin() const noexcept(true) { return std::reverse_iterator<Iterator>(begin_); }
-        constexpr auto rend() const noexcept(true) { return std::reverse_iterator<Iterator>(end_); }
+        constexpr std::conditional_t<restarts::value, Iterator, Iterator const &> begin() const noexcept(nothrow_range<Iterator>::value) {
+            settle();
+            return begin(restarts{});
+        }
+        constexpr Iterator const &end() const noexcept(nothrow_range<Iterator>::value) { settle(); return last_; }
+        constexpr auto rbegin() const noexcept(nothrow_range<Iterator>::value) { return std::reverse_iterator<Iterator>(begin()); }
+        constexpr auto rend() const noexcept(nothrow_range<Iterator>::value) { return std::reverse_iterator<Iterator>(end()); }
+        constexpr stage_context const &context() const noexcept(true) { return context_; }
 
-        constexpr Out first() const noexcept(true) { return *begin_; }
-        constexpr auto firstOrDefault() const noexcept(true) {
+        constexpr Out first() const noexcept(nothrow_range<Iterator>::value) { return *begin(); }
+        constexpr auto firstOrDefault() const noexcept(nothrow_range<Iterator>::value) {
             return any() ? first() : typename std::remove_reference<Out>::type{};
         }
 
-        constexpr Out last() const noexcept(true) { return *std::reverse_iterator<Iterator>(end_); }
-        constexpr auto lastOrDefault() const noexcept(true) {
+        constexpr decltype(auto) last() const noexcept(nothrow_range<Iterator>::value) { return last(category{}); }
+        constexpr auto lastOrDefault() const noexcept(nothrow_range<Iterator>::value) {
             return any() ? last() : typename std::remove_reference<Out>::type{};
         }
 
+        constexpr decltype(auto) elementAt(std::size_t const index) const noexcept(nothrow_range<Iterator>::value) {
+            return elementAt(index, category{});
+        }
+        constexpr auto elementAtOrDefault(std::size_t const index) const noexcept(nothrow_range<Iterator>::value) {
+            auto const it = advance_bounded(begin(), end(), index);
+            return it != end() ? *it : typename std::remove_reference<Out>::type{};
+        }
+
         constexpr auto reverse() const noexcept(true) {
-            return From<std::reverse_iterator<Iterator>>(rend(), rbegin());
+            return reverse(category{});
         }
 
-        template<typename Func>
-        constexpr auto select(Func const &nextloader_) const noexcept(true) {
-            return Select<Iterator, Func>(
+        template<typename Func, typename std::enable_if<!is_column<Iterator, Func>::value, int>::type = 0>
+        constexpr auto select(Func const &nextloader_) const {
+            return Select<Iterator, column_key_t<Iterator, Func>>(
                     this->begin_,
                     this->end_,
-                    nextloader_);
+                    bind_key(begin_, nextloader_),
+                    context_);
+        }
+        template<typename Func, typename std::enable_if<is_column<Iterator, Func>::value, int>::type = 0>
+        constexpr auto select(Func const &member) const {
+            auto const column = column_range(begin_, end_, member);
+            return From<typename decltype(column)::first_type>(column.first, column.second, context_);
         }
         template<typename... Funcs>
         constexpr auto selectMany(Funcs const &...loaders) const noexcept(true) {
-            auto const &nextloader_ = [loaders...] (Out val)
+            auto const &nextloader_ = [loaders = std::make_tuple(as_callable(loaders)...)] (Out val)
             {
-                return std::tuple<decltype(loaders(val))...>(loaders(val)...);
+                return detail::load_all(loaders, val, std::index_sequence_for<Funcs...>{});
             };
 
-            return Select<Iterator, decltype(nextloader_)>(
+            return Select<Iterator, typename std::decay<decltype(nextloader_)>::type>(
                     this->begin_,
                     this->end_,
-                    nextloader_);
+                    nextloader_,
+                    context_);
         }
 
         template<typename Func>
-        constexpr auto where(Func const &nextfilter_) const noexcept(true) {
-            auto const newbegin_ = std::find_if(begin_, end_, nextfilter_);
-            return Where<Iterator, Func>(newbegin_,
-                                         any() ? std::find_if(std::reverse_iterator<Iterator>(this->end_),
-                                                              std::reverse_iterator<Iterator>(newbegin_),
-                                                              nextfilter_).base() : end_,
-                                         nextfilter_
-            );
+        constexpr auto where(Func const &nextfilter_) const {
+            return Where<Iterator, column_key_t<Iterator, Func>>(begin_, end_, bind_key(begin_, nextfilter_), context_);
+        }
+        template<typename Func, typename... Funcs, typename std::enable_if<!is_allocator<Func>::value, int>::type = 0>
+        constexpr auto groupBy(Func const &key, Funcs const &...keys) const {
+            return group<group_row_t<Out, !stable::value>>(default_allocator(), key, keys...);
+        }
+        template<typename... Funcs>
+        constexpr auto groupBy(by_copy_t, Funcs const &...keys) const {
+            return group<group_row_t<Out, true>>(default_allocator(), keys...);
+        }
+        template<typename Alloc, typename... Funcs, typename std::enable_if<is_allocator<Alloc>::value, int>::type = 0>
+        constexpr auto groupBy(Alloc const &alloc, Funcs const &...keys) const {
+            return group<group_row_t<Out, !stable::value>>(alloc, keys...);
+        }
+        template<typename Alloc, typename... Funcs, typename std::enable_if<is_allocator<Alloc>::value, int>::type = 0>
+        constexpr auto groupBy(Alloc const &alloc, by_copy_t, Funcs const &...keys) const {
+            return group<group_row_t<Out, true>>(alloc, keys...);
+        }
+        template<typename... Funcs>
+        constexpr auto groupBy(by_ref_t, Funcs const &...keys) const {
+            return group<group_row_t<Out, !stable::value>>(default_allocator(), keys...);
+        }
+        template<typename Alloc, typename... Funcs, typename std::enable_if<is_allocator<Alloc>::value, int>::type = 0>
+        constexpr auto groupBy(Alloc const &alloc, by_ref_t, Funcs const &...keys) const {
+            return group<group_row_t<Out, !stable::value>>(alloc, keys...);
+        }
+        template<typename Func, typename... Funcs, typename std::enable_if<!is_allocator<Func>::value, int>::type = 0>
+        constexpr auto orderBy(Func const &key, Funcs const &... keys) const noexcept(true) {
+            return Ordered<Iterator, stored_row_t<Out, false>, default_allocator, Func, Funcs...>(*this, default_allocator(), key, keys...);
         }
         template<typename... Funcs>
-        constexpr auto groupBy(Funcs const &...keys) const noexcept(true) {
-            using group_type = group_by<Out, Funcs...>;
-            using map_out = typename group_type::type;
-            auto result = std::make_shared<map_out>();
+        constexpr auto orderBy(by_ref_t, Funcs const &... keys) const noexcept(true) {
+            return Ordered<Iterator, stored_row_t<Out, stable::value>, default_allocator, Funcs...>(*this, default_allocator(), keys...);
+        }
+        template<typename Alloc, typename... Funcs, typename std::enable_if<is_allocator<Alloc>::value, int>::type = 0>
+        constexpr auto orderBy(Alloc const &alloc, Funcs const &... keys) const noexcept(true) {
+            return Ordered<Iterator, stored_row_t<Out, false>, Alloc, Funcs...>(*this, alloc, keys...);
+        }
+        template<typename Alloc, typename... Funcs, typename std::enable_if<is_allocator<Alloc>::value, int>::type = 0>
+        constexpr auto orderBy(Alloc const &alloc, by_ref_t, Funcs const &... keys) const noexcept(true) {
+            return Ordered<Iterator, stored_row_t<Out, stable::value>, Alloc, Funcs...>(*this, alloc, keys...);
+        }
 
-            for (Out it : *this)
-                group_type::emplace(*result, it, keys...);
+        constexpr auto distinct() const noexcept(true) {
+            return distinctBy(identity());
+        }
+        template<typename Func>
+        constexpr auto distinctBy(Func const &key) const {
+            return Distinct<Iterator, column_key_t<Iterator, Func>>(begin_, end_, bind_key(begin_, key), context_);
+        }
+        constexpr auto memoize() const noexcept(true) {
+            return Memoize<Iterator>(begin_, end_, context_);
+        }
+        template<typename Other>
+        constexpr auto unionWith(Other const &other) const noexcept(true) {
+            return combine<set_op::unite>(other);
+        }
+        template<typename Other>
+        constexpr auto intersect(Other const &other) const noexcept(true) {
+            return combine<set_op::intersect>(other);
+        }
+        template<typename Other>
+        constexpr auto except(Other const &other) const noexcept(true) {
+            return combine<set_op::except>(other);
+        }
 
-            return All<typename map_out::iterator, decltype(result)>(result->begin(), result->end(), result);
+        template<typename Inner, typename OuterKey, typename InnerKey, typename Func>
+        constexpr auto join(Inner const &inner, OuterKey const &outerKey, InnerKey const &innerKey,
+                            Func const &result) const {
+            using state_t = join_state<Iterator, Inner, column_key_t<Iterator, OuterKey>, callable_t<InnerKey>, Func>;
+            return Join<Iterator, state_t>(begin_, end_, std::make_shared<state_t const>(*this, inner, bind_key(begin_, outerKey),
+                                                                                        as_callable(innerKey), result));
+        }
+        template<typename Inner, typename OuterKey, typename InnerKey, typename Func>
+        constexpr auto groupJoin(Inner const &inner, OuterKey const &outerKey, InnerKey const &innerKey,
+                                 Func const &result) const {
+            using state_t = join_state<Iterator, Inner, column_key_t<Iterator, OuterKey>, callable_t<InnerKey>, Func>;
+            return GroupJoin<Iterator, state_t>(begin_, end_, std::make_shared<state_t const>(*this, inner, bind_key(begin_, outerKey),
+                                                                                              as_callable(innerKey), result));
         }
-        template<typename... Funcs>
-        constexpr auto orderBy(Funcs const &... keys) const noexcept(true) {
-            auto proxy = std::make_shared<std::vector<typename std::remove_reference<Out>::type>>();
-            std::copy(begin_, end_, std::back_inserter(*proxy));
-            std::sort(proxy->begin(), proxy->end(), [keys...](Out a, Out b) -> bool
-            {
-                return order_by_current(a, b, keys...);
-            });
 
-            return All<decltype(proxy->begin()), decltype(proxy)>(proxy->begin(), proxy->end(), proxy);
+        template<typename Handle>
+        constexpr auto concat(TEnumerable<Handle> const &other) const noexcept(true) {
+            auto const &rhs = static_cast<TState<typename Handle::iterator> const &>(static_cast<Handle const &>(other));
+            return Concat<Iterator, typename Handle::iterator>(begin_, end_, rhs.begin_, rhs.end_, join_context(rhs.context_));
         }
 
         constexpr auto skip(std::size_t const offset) const noexcept(true) {
-            auto ret = begin_;
-            for (std::size_t i = 0; i < offset && ret != end_; ++ret, ++i);
-
-            return From<Iterator>(ret, end_);
+            return seek_front(skip_seek{offset});
         }
         template<typename Func>
-        constexpr auto skip_while(Func const &func) const noexcept(true) {
-            auto ret = begin_;
-            while (ret != end_ && func(*ret))
-                ++ret;
-            return From<Iterator>(ret, end_);
+        constexpr auto skip_while(Func const &func) const {
+            return seek_front(skip_while_seek<column_key_t<Iterator, Func>>{bind_key(begin_, func)});
         }
 
         constexpr auto take(int const max) const noexcept(true) {
-            return Take<Iterator>(begin_, end_, max);
+            return take(max, category{});
         }
         template<typename Func>
-        constexpr auto take_while(Func const &func) const noexcept(true) {
-            return Take<Iterator, Func>(begin_, end_, func);
+        constexpr auto take_while(Func const &func) const {
+            return Take<Iterator, column_key_t<Iterator, Func>>(begin_, end_, bind_key(begin_, func), context_);
+        }
+
+        // batches of up to size rows (a size of 0 counts as 1)
+        constexpr auto chunk(std::size_t const size) const noexcept(true) {
+            return chunk(size ? size : 1, is_span_source<Iterator>{});
         }
 
         template<typename Func>
-        constexpr void each(Func const &pred) const noexcept(true) {
-            for (Out it : *this)
+        constexpr void each(Func const &pred) const noexcept(nothrow_range<Iterator>::value) {
+            push_range(begin(), end(), [&pred](Out it) {
                 pred(it);
+                return true;
+            });
         }
 
         template <typename T>
-        constexpr bool contains(T const &elem) const noexcept(true)
+        constexpr bool contains(T const &elem) const noexcept(nothrow_range<Iterator>::value)
         {
-            for (Out it : *this)
-                if (it == elem)
-                    return true;
-            return false;
+            return contains_range(begin(), end(), elem);
         }
-        constexpr bool any() const noexcept(true) {
-            return begin_ != end_;
+        constexpr bool any() const noexcept(nothrow_range<Iterator>::value) {
+            return begin() != end();
         }
-        constexpr auto count() const noexcept(true) {
-            std::size_t number{ 0 };
-            for (auto it = begin_; it != end_; ++it, ++number);
-            return number;
+        constexpr auto count() const noexcept(nothrow_range<Iterator>::value) {
+            return count_range(begin(), end());
+        }
+
+        // the stages so far run on a producer thread, up to capacity rows ahead of the consumer
+        constexpr auto prefetch(std::size_t const capacity) const noexcept(true) {
+            return Pipelined<Iterator>(begin_, end_, capacity, context_);
+        }
+
+        constexpr auto asParallel(std::size_t const threads) const noexcept(true) {
+            return Parallel<Iterator>(begin_, end_, threads, thread_pool::instance(), context_);
         }
 
         constexpr auto all() const noexcept(true)
         {
-            using vec_out = typename std::vector<typename std::remove_const<typename std::remove_reference<Out>::type>::type>;
-            auto proxy = std::make_shared<vec_out>();
-            for (Out it : *this)
-                proxy->push_back(it);
-            return All<typename vec_out::iterator, decltype(proxy)>(proxy->begin(), proxy->end(), proxy);
-        }
-        constexpr auto min() const noexcept(true) {
-            typename std::remove_const<typename std::remove_reference<decltype(*begin_)>::type>::type val(*begin_);
-            for (Out it : *this)
-                if (it > val)
-                    val = it;
-            return val;
-        }
-        constexpr auto max() const noexcept(true) {
-            typename std::remove_const<typename std::remove_reference<decltype(*begin_)>::type>::type val(*begin_);
-            for (Out it : *this)
-                if (it < val)
-                    val = it;
-            return val;
-        }
-        constexpr auto sum() const noexcept(true) {
-            typename std::remove_const<typename std::remove_reference<Out>::type>::type result{};
-            for (Out it : *this)
-                result += it;
-            return result;
+            return all(default_allocator());
+        }
+        constexpr auto all(by_ref_t) const noexcept(true)
+        {
+            return materialize<stored_row_t<Out, stable::value>>(default_allocator());
+        }
+        template<typename Alloc>
+        constexpr auto all(Alloc const &alloc) const noexcept(true)
+        {
+            return materialize<stored_row_t<Out, false>>(alloc);
+        }
+        template<typename Alloc>
+        constexpr auto all(Alloc const &alloc, by_ref_t) const noexcept(true)
+        {
+            return materialize<stored_row_t<Out, stable::value>>(alloc);
+        }
+        template<typename... Tags>
+        constexpr auto reduce(Tags const &...tags) const noexcept(nothrow_range<Iterator>::value) {
+            return aggregate_range(begin(), end(), tags...);
+        }
+        constexpr auto min() const noexcept(nothrow_range<Iterator>::value) {
+            return min_range(begin(), end());
+        }
+        constexpr auto max() const noexcept(nothrow_range<Iterator>::value) {
+            return max_range(begin(), end());
+        }
+        constexpr auto sum() const noexcept(nothrow_range<Iterator>::value) {
+            return sum_range(begin(), end());
+        }
+
+    private:
+        template<typename>
+        friend class TState;
+
+        // a copy takes the settled bounds when there are some, single-pass ranges are not
+        // settled twice
+        TState(TState const &rhs, bool const settled)
+                : begin_(rhs.begin_), end_(rhs.end_), first_(settled ? rhs.first_ : rhs.begin_), last_(settled ? rhs.last_ : rhs.end_),
+                  settled_(settled), context_(rhs.context_) {}
+
+        constexpr Iterator const &begin(std::false_type) const noexcept(true) { return first_; }
+        Iterator begin(std::true_type) const noexcept(nothrow_range<Iterator>::value) {
+            auto it = begin_;
+            linq::settle(it);
+            return it;
+        }
+        // keeps the stages it wraps unsettled until a terminal runs
+        template<typename>
+        friend class Parallel;
+
+        template<typename Row, typename Alloc>
+        constexpr auto materialize(Alloc const &alloc) const noexcept(true)
+        {
+            using vec_out = std::vector<Row, rebind_alloc_t<Alloc, Row>>;
+            auto const builder = [self = *this](vec_out &proxy) {
+                collect(self.begin(), self.end(), proxy);
+            };
+            return make_all<vec_out>(builder, vec_out(alloc));
+        }
+
+        stage_context join_context(stage_context const &other) const {
+            if (!context_ || !other)
+                return context_ ? context_ : other;
+            return std::make_shared<std::pair<stage_context, stage_context> const>(context_, other);
+        }
+
+        template<set_op Op, typename Other>
+        constexpr auto combine(Other const &other) const noexcept(true) {
+            using builder_t = set_builder<Op, TState, Other>;
+            return make_all<typename builder_t::container_type>(builder_t(*this, other));
+        }
+
+        template<typename Row, typename Alloc, typename... Funcs>
+        constexpr auto group(Alloc const &alloc, Funcs const &...keys) const {
+            return Group<Iterator, Row, Alloc, column_key_t<Iterator, Funcs>...>(*this, alloc, bind_key(begin_, keys)...);
+        }
+
+        // the backward step of a filter stops at a match only and would run off the front of
+        // its source looking for one: an empty range gives *begin(), as the forward walk does
+        constexpr Out last(std::bidirectional_iterator_tag) const noexcept(nothrow_range<Iterator>::value) {
+            return any() ? *std::reverse_iterator<Iterator>(end()) : *begin();
+        }
+        // forward only: the last position is found by a walk
+        constexpr Out last(std::forward_iterator_tag) const noexcept(nothrow_range<Iterator>::value) {
+            auto ret = begin();
+            for (auto it = ret; it != end(); ++it)
+                ret = it;
+            return *ret;
+        }
+        // single pass: a row does not outlive the next step, the last one is copied out
+        constexpr auto last(std::input_iterator_tag) const noexcept(nothrow_range<Iterator>::value) {
+            typename std::decay<Out>::type ret{};
+            push_range(begin(), end(), [&ret](Out it) {
+                ret = it;
+                return true;
+            });
+            return ret;
+        }
+
+        constexpr Out elementAt(std::size_t const index, std::forward_iterator_tag) const noexcept(nothrow_range<Iterator>::value) {
+            return *std::next(begin(), static_cast<typename Iterator::difference_type>(index));
+        }
+        // single pass: the row may live in the iterator, it is copied out before that goes
+        constexpr auto elementAt(std::size_t const index, std::input_iterator_tag) const noexcept(nothrow_range<Iterator>::value) {
+            return typename std::decay<Out>::type(*std::next(begin(), static_cast<typename Iterator::difference_type>(index)));
+        }
+
+        constexpr auto reverse(std::bidirectional_iterator_tag) const noexcept(true) {
+            return From<std::reverse_iterator<Iterator>>(rend(), rbegin(), context_);
+        }
+        constexpr auto reverse(std::input_iterator_tag) const noexcept(true) { return all().reverse(); }
+
+        constexpr auto chunk(std::size_t const size, std::true_type) const noexcept(true) {
+            using it_t = span_chunk_it<Iterator>;
+            return From<it_t>(it_t(begin_, end_, size, false), it_t(begin_, end_, size, true), context_);
+        }
+        constexpr auto chunk(std::size_t const size, std::false_type) const noexcept(true) {
+            using it_t = chunk_it<Iterator>;
+            return From<it_t>(it_t(begin_, end_, size), it_t(end_, end_, size), context_);
+        }
+
+        constexpr auto take(int const max, std::random_access_iterator_tag) const noexcept(true) {
+            using it_t = seek_it<Iterator, take_seek>;
+            auto const count = take_seek{static_cast<std::size_t>(max > 0 ? max : 0)};
+            auto const seek = hold(count, context_);
+            return From<it_t>(it_t(begin_, seek), it_t(end_, begin_, seek), seek.context);
         }
 
+        // the begin bound moves once the range settles
+        template<typename Seek>
+        constexpr auto seek_front(Seek const &func) const noexcept(true) {
+            using it_t = seek_it<Iterator, Seek>;
+            auto const seek = hold(func, context_);
+            return From<it_t>(it_t(begin_, end_, seek), it_t(end_, seek), seek.context);
+        }
+        constexpr auto take(int const max, std::input_iterator_tag) const noexcept(true) {
+            return Take<Iterator>(begin_, end_, max, context_);
+        }
     };
 }
 
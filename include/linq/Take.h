@@ -4,10 +4,12 @@
 namespace linq
 {
     template <typename Base, typename In>
-    class take_it : public Base {
+    class take_it : public Base, private closure_ref<In, take_it<Base, In>> {
+        using closure_t = closure_ref<In, take_it<Base, In>>;
     public:
         typedef Base                             base;
-        typedef typename Base::iterator_category iterator_category;
+        typedef min_category_t<typename Base::iterator_category,
+                               std::bidirectional_iterator_tag> iterator_category;
         typedef decltype(*std::declval<Base>())     value_type;
         typedef typename Base::difference_type     difference_type;
         typedef typename Base::pointer             pointer;
@@ -15,49 +17,60 @@ namespace linq
 
         take_it() = delete;
         take_it(const take_it &) = default;
-        take_it(Base const &base, In const &when) noexcept(true) : Base(base), _when(when)
+        take_it(Base const &base, closure_t const &when) noexcept(true) : Base(base), closure_t(when)
         {}
 
         constexpr auto const &operator=(take_it const &rhs) noexcept(true) {
-            static_cast<Base>(*this) = static_cast<Base const &>(rhs);
+            static_cast<Base &>(*this) = static_cast<Base const &>(rhs);
             return *this;
         }
-        constexpr auto const &operator++() noexcept(true) {
+        constexpr auto const &operator++() noexcept(nothrow_range<Base>::value) {
             static_cast<Base &>(*this).operator++();
             return (*this);
         }
-        constexpr auto const operator++(int) noexcept(true) {
+        constexpr auto const operator++(int) noexcept(nothrow_range<Base>::value) {
             auto tmp = *this;
             operator++();
             return (tmp);
         }
-        constexpr auto const &operator--() noexcept(true) {
+        constexpr auto const &operator--() noexcept(nothrow_range<Base>::value) {
             static_cast<Base &>(*this).operator--();
             return (*this);
         }
-        constexpr auto const operator--(int) noexcept(true) {
+        constexpr auto const operator--(int) noexcept(nothrow_range<Base>::value) {
             auto tmp = *this;
             operator--();
             return (tmp);
         }
-        constexpr bool operator!=(take_it const &rhs) const noexcept(true) {
+        constexpr bool operator!=(take_it const &rhs) const noexcept(nothrow_range<Base>::value) {
             return static_cast<Base const &>(*this) != static_cast<Base const &>(rhs)
-                   && _when(*static_cast<Base const &>(*this));
+                   && when()(*static_cast<Base const &>(*this));
         }
-        constexpr bool operator==(take_it const &rhs) const noexcept(true) {
+        constexpr bool operator==(take_it const &rhs) const noexcept(nothrow_range<Base>::value) {
             return static_cast<Base const &>(*this) == static_cast<Base const &>(rhs)
-                   || !_when(*static_cast<Base const &>(rhs));
+                   || !when()(*static_cast<Base const &>(rhs));
         }
 
-    private:
-        In const _when;
+        constexpr void settle() noexcept(nothrow_range<Base>::value) {
+            linq::settle(static_cast<Base &>(*this));
+        }
+
+        constexpr In const &when() const noexcept(true) { return closure_t::get(); }
+
+        constexpr closure_t const &closure() const noexcept(true) { return *this; }
+
+        static constexpr take_it sentinel(Base const &end, closure_t const &when) noexcept(true) { return take_it(end, when); }
+        constexpr Base bound(take_it const &end) const noexcept(true) {
+            return std::find_if_not(static_cast<Base const &>(*this), static_cast<Base const &>(end), when());
+        }
     };
 
     template <typename Base>
     class take_it<Base, int> : public Base {
     public:
         typedef Base                             base;
-        typedef typename Base::iterator_category iterator_category;
+        typedef min_category_t<typename Base::iterator_category,
+                               std::bidirectional_iterator_tag> iterator_category;
         typedef decltype(*std::declval<Base>())     value_type;
         typedef typename Base::difference_type     difference_type;
         typedef typename Base::pointer             pointer;
@@ -65,40 +78,58 @@ namespace linq
 
         take_it() = delete;
         take_it(const take_it &) = default;
-        take_it(Base const &base, int const max) noexcept(true) : Base(base), max_(-max)
+        take_it(Base const &base, int const max) noexcept(true) : Base(base), remaining_(max > 0 ? max : 0)
+        {}
+        take_it(Base const &base, held_closure<int> const &max) noexcept(true) : take_it(base, max.get)
         {}
 
         constexpr auto const &operator=(take_it const &rhs) noexcept(true) {
-            static_cast<Base>(*this) = static_cast<Base const &>(rhs);
+            static_cast<Base &>(*this) = static_cast<Base const &>(rhs);
+            remaining_ = rhs.remaining_;
             return *this;
         }
-        constexpr auto const &operator++() noexcept(true) {
+        constexpr auto const &operator++() noexcept(nothrow_range<Base>::value) {
             static_cast<Base &>(*this).operator++();
+            --remaining_;
             return (*this);
         }
-        constexpr auto operator++(int) noexcept(true) {
+        constexpr auto operator++(int) noexcept(nothrow_range<Base>::value) {
             auto tmp = *this;
             operator++();
             return (tmp);
         }
-        constexpr auto const &operator--() noexcept(true) {
+        constexpr auto const &operator--() noexcept(nothrow_range<Base>::value) {
             static_cast<Base &>(*this).operator--();
+            ++remaining_;
             return (*this);
         }
-        constexpr auto operator--(int) noexcept(true) {
+        constexpr auto operator--(int) noexcept(nothrow_range<Base>::value) {
             auto tmp = *this;
             operator--();
             return (tmp);
         }
-        constexpr bool operator!=(take_it const &rhs) const noexcept(true) {
-            return  static_cast<Base const &>(*this) != static_cast<Base const &>(rhs) && max_++ < 0;
+        // a counted range ends on whichever comes first: the base end or the count
+        constexpr bool operator==(take_it const &rhs) const noexcept(nothrow_range<Base>::value) {
+            return remaining_ == rhs.remaining_ || static_cast<Base const &>(*this) == static_cast<Base const &>(rhs);
+        }
+        constexpr bool operator!=(take_it const &rhs) const noexcept(nothrow_range<Base>::value) {
+            return !operator==(rhs);
+        }
+
+        constexpr void settle() noexcept(nothrow_range<Base>::value) {
+            linq::settle(static_cast<Base &>(*this));
         }
-        constexpr bool operator==(take_it const &rhs) const noexcept(true) {
-            return  static_cast<Base const &>(*this) == static_cast<Base const &>(rhs) || max_++ >= 0;
+
+        constexpr int remaining() const noexcept(true) { return remaining_; }
+
+        static constexpr take_it sentinel(Base const &end, held_closure<int> const &) noexcept(true) { return take_it(end, 0); }
+        constexpr Base bound(take_it const &end) const noexcept(true) {
+            return advance_bounded(static_cast<Base const &>(*this), static_cast<Base const &>(end),
+                                   static_cast<std::size_t>(remaining_ - end.remaining_));
         }
 
     private:
-        mutable int max_;
+        int remaining_;
     };
 
     template <typename Base, typename In = int>
@@ -115,8 +146,32 @@ namespace linq
                 : base_t(static_cast<base_t const &>(rhs))
         {}
 
-        Take(Base const &begin, Base const &end, In const &in) noexcept(true)
-                : base_t(iterator(begin, in), iterator(end, in))
+        Take(Base const &begin, Base const &end, In const &in, stage_context const &upstream)
+                : Take(begin, end, hold(in, upstream))
+        {}
+
+        // the end iterator is only a sentinel, walking backward needs the real last position;
+        // a single-pass range cannot be walked twice to find it
+        constexpr decltype(auto) last() const noexcept(true) { return last(category{}); }
+        constexpr auto lastOrDefault() const noexcept(true) { return lastOrDefault(category{}); }
+        constexpr auto reverse() const noexcept(true) { return reverse(category{}); }
+
+    private:
+        using category = typename std::iterator_traits<Base>::iterator_category;
+
+        constexpr decltype(auto) last(std::forward_iterator_tag) const noexcept(true) { return bounded().last(); }
+        constexpr decltype(auto) last(std::input_iterator_tag) const noexcept(true) { return base_t::last(); }
+        constexpr auto lastOrDefault(std::forward_iterator_tag) const noexcept(true) { return bounded().lastOrDefault(); }
+        constexpr auto lastOrDefault(std::input_iterator_tag) const noexcept(true) { return base_t::lastOrDefault(); }
+        constexpr auto reverse(std::forward_iterator_tag) const noexcept(true) { return bounded().reverse(); }
+        constexpr auto reverse(std::input_iterator_tag) const noexcept(true) { return base_t::reverse(); }
+
+        constexpr auto bounded() const noexcept(true) {
+            return From<Base>(this->begin(), this->begin().bound(this->end()), this->context());
+        }
+
+        Take(Base const &begin, Base const &end, held_closure<In> const &in) noexcept(true)
+                : base_t(iterator(begin, in), iterator::sentinel(end, in), in.context)
         {}
 
     };
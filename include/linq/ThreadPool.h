@@ -0,0 +1,156 @@
+#ifndef THREADPOOL_H_
+# define THREADPOOL_H_
+
+namespace linq
+{
+    // fixed set of workers, one task deque each; idle workers steal from the others' front
+    // and the thread calling run() takes part in the work until its batch is drained.
+    class thread_pool
+    {
+        struct batch
+        {
+            void (*invoke)(void const *, std::size_t);
+            void const *func;
+            std::size_t pending;
+            std::mutex lock;
+            std::condition_variable done;
+        };
+        struct task
+        {
+            batch *owner;
+            std::size_t index;
+        };
+        struct queue
+        {
+            std::mutex lock;
+            std::deque<task> tasks;
+        };
+
+    public:
+        thread_pool(thread_pool const &) = delete;
+        thread_pool &operator=(thread_pool const &) = delete;
+        explicit thread_pool(std::size_t const threads = default_size())
+                : queues_(threads + 1)
+        {
+            for (auto &it : queues_)
+                it.reset(new queue());
+            for (std::size_t i = 1; i <= threads; ++i)
+                workers_.emplace_back([this, i]() { work(i); });
+        }
+        ~thread_pool()
+        {
+            {
+                std::lock_guard<std::mutex> guard(lock_);
+                stop_ = true;
+            }
+            wake_.notify_all();
+            for (auto &it : workers_)
+                it.join();
+        }
+
+        static thread_pool &instance()
+        {
+            static thread_pool pool;
+            return pool;
+        }
+        static std::size_t default_size() noexcept(true)
+        {
+            auto const hardware = std::thread::hardware_concurrency();
+            return hardware > 1 ? hardware - 1 : 1;
+        }
+
+        // workers plus the calling thread
+        std::size_t size() const noexcept(true) { return workers_.size() + 1; }
+
+        // calls func(i) for every i in [0, count) and returns once all calls completed
+        template<typename Func>
+        void run(std::size_t const count, Func const &func)
+        {
+            if (!count)
+                return;
+            batch job;
+            job.invoke = [](void const *f, std::size_t const index) { (*static_cast<Func const *>(f))(index); };
+            job.func = &func;
+            job.pending = count;
+            {
+                std::lock_guard<std::mutex> guard(lock_);
+                queued_ += count;
+            }
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                auto &target = *queues_[i % queues_.size()];
+                std::lock_guard<std::mutex> guard(target.lock);
+                target.tasks.push_back(task{ &job, i });
+            }
+            wake_.notify_all();
+
+            task next;
+            while (pop(0, next) || steal(0, next))
+                execute(next);
+            std::unique_lock<std::mutex> guard(job.lock);
+            job.done.wait(guard, [&job]() { return !job.pending; });
+        }
+
+    private:
+        void work(std::size_t const self)
+        {
+            task next;
+            for (;;)
+            {
+                if (pop(self, next) || steal(self, next))
+                {
+                    execute(next);
+                    continue;
+                }
+                std::unique_lock<std::mutex> guard(lock_);
+                wake_.wait(guard, [this]() { return stop_ || queued_; });
+                if (stop_)
+                    return;
+            }
+        }
+        bool take(queue &from, task &out, bool const back)
+        {
+            std::lock_guard<std::mutex> guard(from.lock);
+            if (from.tasks.empty())
+                return false;
+            if (back)
+            {
+                out = from.tasks.back();
+                from.tasks.pop_back();
+            }
+            else
+            {
+                out = from.tasks.front();
+                from.tasks.pop_front();
+            }
+            std::lock_guard<std::mutex> count(lock_);
+            --queued_;
+            return true;
+        }
+        bool pop(std::size_t const self, task &out) { return take(*queues_[self], out, true); }
+        bool steal(std::size_t const self, task &out)
+        {
+            for (std::size_t i = 1; i < queues_.size(); ++i)
+                if (take(*queues_[(self + i) % queues_.size()], out, false))
+                    return true;
+            return false;
+        }
+        static void execute(task const &next)
+        {
+            auto &job = *next.owner;
+            job.invoke(job.func, next.index);
+            std::lock_guard<std::mutex> guard(job.lock);
+            if (!--job.pending)
+                job.done.notify_all();
+        }
+
+        std::vector<std::unique_ptr<queue>> queues_;
+        std::vector<std::thread> workers_;
+        std::mutex lock_;
+        std::condition_variable wake_;
+        std::size_t queued_ = 0;
+        bool stop_ = false;
+    };
+}
+
+#endif // !THREADPOOL_H_
@@ -5,49 +5,134 @@ namespace linq
 {
     /* utils */
 
-    template<typename Key, typename Value, bool is_basic_type>
-    struct map_type
+    template<typename Category, typename Limit>
+    using min_category_t = typename std::conditional<std::is_base_of<Limit, Category>::value, Limit, Category>::type;
+
+    // materializing operators take an optional allocator as their first argument
+    template<typename T, typename = void>
+    struct is_allocator : std::false_type {};
+    template<typename T>
+    struct is_allocator<T, decltype(void(std::declval<typename T::value_type *&>() = std::declval<T &>().allocate(std::size_t(1))))>
+            : std::true_type {};
+
+    template<typename Alloc, typename T>
+    using rebind_alloc_t = typename std::allocator_traits<Alloc>::template rebind_alloc<T>;
+
+    typedef std::allocator<char> default_allocator;
+
+    // closures of the stages of a query, owned once by the stage handles (shared down the
+    // chain so copies and derived ranges keep them alive) instead of by every iterator
+    typedef std::shared_ptr<void const> stage_context;
+
+    namespace detail
     {
-        typedef std::unordered_map<Key, Value> type;
-    };
-    template<typename Key, typename Value>
-    struct map_type<Key, Value, false>
+        enum class closure_mode { empty, value, shared };
+
+        template<typename F>
+        constexpr closure_mode closure_mode_of() noexcept(true) {
+            return std::is_empty<F>::value && std::is_class<F>::value ? closure_mode::empty
+                 : std::is_trivially_copyable<F>::value && sizeof(F) <= sizeof(void *) ? closure_mode::value
+                 : closure_mode::shared;
+        }
+    }
+
+    // a stage closure and the context that owns it, as handed to the stage iterators
+    template<typename F>
+    struct held_closure
     {
-        typedef std::map<Key, Value> type;
+        F const &get;
+        stage_context context;
     };
 
-    template<typename In, typename KeyLoader = void, typename... Funcs>
-    struct group_by
+    // what an iterator keeps of its stage closure: nothing for stateless lambdas (an empty
+    // base), a copy when it is no bigger than a pointer, otherwise a pointer into the stage
+    // context that also keeps the context alive, so iterators outlive their query handle.
+    // Owner is the iterator itself, so that nested stages never share a base
+    template<typename F, typename Owner, detail::closure_mode = detail::closure_mode_of<F>()>
+    class closure_ref : private F
     {
-        using Out = decltype(std::declval<KeyLoader>()(std::declval<In>()));
-        typedef typename map_type<Out, typename group_by<In, Funcs...>::type, std::is_fundamental<Out>::value>::type type;
-
-        constexpr static void emplace(type &handle, In const &val, KeyLoader const &func, Funcs const &...funcs) noexcept(true)
-        {
-            group_by<In, Funcs...>::emplace(handle[func(val)], val, funcs...);
-        }
+    public:
+        constexpr closure_ref(F const &f) noexcept(true) : F(f) {}
+        constexpr closure_ref(held_closure<F> const &held) noexcept(true) : F(held.get) {}
+        constexpr F const &get() const noexcept(true) { return *this; }
     };
-    template<typename In, typename KeyLoader>
-    struct group_by<In, KeyLoader>
+    template<typename F, typename Owner>
+    class closure_ref<F, Owner, detail::closure_mode::value>
     {
-        using Out = decltype(std::declval<KeyLoader>()(std::declval<In>()));
-        typedef typename map_type<Out, typename group_by<In>::type, std::is_fundamental<Out>::value>::type type;
-
-        constexpr static void emplace(type &handle, In const &val, KeyLoader const &func) noexcept(true)
-        {
-            group_by<In>::emplace(handle[func(val)], val);
-        }
+    public:
+        constexpr closure_ref(F const &f) noexcept(true) : f_(f) {}
+        constexpr closure_ref(held_closure<F> const &held) noexcept(true) : f_(held.get) {}
+        constexpr F const &get() const noexcept(true) { return f_; }
+    private:
+        F f_;
     };
-    template<typename In>
-    struct group_by<In>
+    template<typename F, typename Owner>
+    class closure_ref<F, Owner, detail::closure_mode::shared>
     {
-        typedef std::vector<typename std::remove_reference<In>::type> type;
+    public:
+        constexpr closure_ref(held_closure<F> const &held) noexcept(true) : f_(held.context, &held.get) {}
+        constexpr F const &get() const noexcept(true) { return *f_; }
+    private:
+        std::shared_ptr<F const> f_;
+    };
 
-        constexpr static void emplace(type &vec, In const &val) noexcept(true)
-        {
-            vec.push_back(val);
+    namespace detail
+    {
+        template<typename F>
+        held_closure<F> hold(F const &f, stage_context const &upstream, std::false_type) {
+            return held_closure<F>{f, upstream};
         }
-    };
+        template<typename F>
+        held_closure<F> hold(F const &f, stage_context const &upstream, std::true_type) {
+            auto const node = std::make_shared<std::pair<F const, stage_context> const>(f, upstream);
+            return held_closure<F>{node->first, node};
+        }
+    }
+    // copies f into the context of a new stage when its iterators only point to it
+    template<typename F>
+    held_closure<F> hold(F const &f, stage_context const &upstream) {
+        return detail::hold(f, upstream, std::integral_constant<bool, detail::closure_mode_of<F>() == detail::closure_mode::shared>{});
+    }
+
+    namespace detail
+    {
+        template<typename It>
+        constexpr auto settle(It &it, int) noexcept(noexcept(it.settle())) -> decltype(it.settle(), void()) { it.settle(); }
+        template<typename It>
+        constexpr void settle(It &, long) noexcept(true) {}
+    }
+    // deferred stages finish positioning their iterators (first match, materialized
+    // container) here, on first enumeration instead of when the query is built
+    template<typename It>
+    constexpr void settle(It &it) noexcept(noexcept(detail::settle(it, 0))) { detail::settle(it, 0); }
+
+    // whether enumerating It can throw: the iterators of a Prefetch stage rethrow what their
+    // producer threw, and the stages over them let it through to the enumeration
+    template<typename It>
+    using nothrow_range = std::integral_constant<bool, noexcept(*std::declval<It &>()) && noexcept(++std::declval<It &>()) &&
+                                                       noexcept(std::declval<It const &>() != std::declval<It const &>()) &&
+                                                       noexcept(linq::settle(std::declval<It &>()))>;
+
+    template<typename Iterator>
+    constexpr Iterator advance_bounded(Iterator it, Iterator const &end, std::size_t const n,
+                                       std::random_access_iterator_tag) noexcept(nothrow_range<Iterator>::value)
+    {
+        auto const size = static_cast<std::size_t>(end - it);
+        return it + static_cast<typename Iterator::difference_type>(n < size ? n : size);
+    }
+    template<typename Iterator>
+    constexpr Iterator advance_bounded(Iterator it, Iterator const &end, std::size_t n,
+                                       std::input_iterator_tag) noexcept(nothrow_range<Iterator>::value)
+    {
+        for (; n && it != end; ++it, --n);
+        return it;
+    }
+
+    template<typename Iterator>
+    constexpr Iterator advance_bounded(Iterator const &it, Iterator const &end, std::size_t const n) noexcept(nothrow_range<Iterator>::value)
+    {
+        return advance_bounded(it, end, n, typename std::iterator_traits<Iterator>::iterator_category{});
+    }
 
     // order utils
 
@@ -128,8 +213,22 @@ namespace linq
             return (static_cast<BaseFilter const &>(*this)).next(key_(lhs), key_(rhs));
         }
 
+        // same ordering split in two, for callers that extract the keys once up front
+        template <typename In>
+        constexpr auto key(In const &in) const { return key_(in); }
+        template <typename Lhs, typename Rhs>
+        constexpr bool before(Lhs const &lhs, Rhs const &rhs) const
+        {
+            return (static_cast<BaseFilter const &>(*this))(lhs, rhs);
+        }
+        template <typename Lhs, typename Rhs>
+        constexpr bool tied(Lhs const &lhs, Rhs const &rhs) const
+        {
+            return (static_cast<BaseFilter const &>(*this)).next(lhs, rhs);
+        }
+
     private:
-        Key const &key_;
+        Key const key_;
     };
 
     template<typename In, typename Filter, typename... Filters>
@@ -143,6 +242,35 @@ namespace linq
         return key.apply(a, b);
     }
 
+    // a data member pointer works wherever a key, loader or predicate does: &User::likes reads
+    // the field of a row, or of a row proxy of a columnar source through project()
+    template<typename M, typename C>
+    constexpr M const &project(C const &in, M C::*member) noexcept(true) { return in.*member; }
+    template<typename M, typename C>
+    struct member_of
+    {
+        M C::*member;
+
+        template<typename In>
+        constexpr decltype(auto) operator()(In const &in) const noexcept(noexcept(project(in, member))) { return project(in, member); }
+    };
+
+    template<typename F>
+    constexpr F const &as_callable(F const &f) noexcept(true) { return f; }
+    template<typename M, typename C, typename std::enable_if<!std::is_function<M>::value, int>::type = 0>
+    constexpr member_of<M, C> as_callable(M C::*member) noexcept(true) { return member_of<M, C>{member}; }
+    template<typename F>
+    using callable_t = typename std::decay<decltype(as_callable(std::declval<F const &>()))>::type;
+
+    namespace detail
+    {
+        // the SelectMany tuple, element types as the loaders return them
+        template<typename Loaders, typename In, std::size_t... I>
+        constexpr auto load_all(Loaders const &loaders, In &&in, std::index_sequence<I...>) {
+            return std::tuple<decltype(std::get<I>(loaders)(in))...>(std::get<I>(loaders)(in)...);
+        }
+    }
+
     template <typename Key>
     using asc_t = Filter<TFilter<eOrderType::asc>, Key>;
     template <typename Key>
@@ -154,9 +282,9 @@ namespace linq
         return Filter<BaseFilter, Key, Params...>(key, params...);
     }
     template <typename Key>
-    auto asc(Key const &key) noexcept(true) { return asc_t<Key>(key); }
+    auto asc(Key const &key) noexcept(true) { return asc_t<callable_t<Key>>(as_callable(key)); }
     template <typename Key>
-    auto desc(Key const &key) noexcept(true) { return desc_t<Key>(key); }
+    auto desc(Key const &key) noexcept(true) { return desc_t<callable_t<Key>>(as_callable(key)); }
 
     /*! utils */
 }
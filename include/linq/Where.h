@@ -4,10 +4,12 @@
 namespace linq
 {
     template <typename Base, typename Filter>
-    class where_it : public Base {
+    class where_it : public Base, private closure_ref<Filter, where_it<Base, Filter>> {
+        using closure_t = closure_ref<Filter, where_it<Base, Filter>>;
     public:
         typedef Base base;
-        typedef typename Base::iterator_category                iterator_category;
+        typedef min_category_t<typename Base::iterator_category,
+                               std::bidirectional_iterator_tag> iterator_category;
         typedef decltype(*std::declval<Base>())                    value_type;
         typedef typename Base::difference_type                    difference_type;
         typedef typename Base::pointer                            pointer;
@@ -15,44 +17,53 @@ namespace linq
 
         where_it() = delete;
         where_it(where_it const &) = default;
-        where_it(Base const &base, Base const &begin, Base const &end, Filter const &filter) noexcept(true)
-                : Base(base), begin_(begin), end_(end), filter_(filter) {}
+        where_it(Base const &base, Base const &end, closure_t const &filter) noexcept(true)
+                : Base(base), closure_t(filter), end_(end) {}
 
         constexpr auto const &operator=(where_it const &rhs) noexcept(true) {
-            static_cast<Base>(*this) = static_cast<Base const &>(rhs);
+            static_cast<Base &>(*this) = static_cast<Base const &>(rhs);
+            end_ = rhs.end_;
             return *this;
         }
-        constexpr auto const &operator++() noexcept(true) {
+        constexpr auto const &operator++() noexcept(nothrow_range<Base>::value) {
             do
             {
                 static_cast<Base &>(*this).operator++();
-            } while (static_cast<Base const &>(*this) != end_ && !filter_(*static_cast<Base const &>(*this)));
+            } while (static_cast<Base const &>(*this) != end_ && !filter()(*static_cast<Base const &>(*this)));
             return *this;
         }
-        constexpr auto operator++(int) noexcept(true)
+        constexpr auto operator++(int) noexcept(nothrow_range<Base>::value)
         {
             auto tmp = *this;
             operator++();
             return (tmp);
         }
-        constexpr auto const &operator--() noexcept(true) {
+        constexpr auto const &operator--() noexcept(nothrow_range<Base>::value) {
             do
             {
                 static_cast<Base &>(*this).operator--();
-            } while (static_cast<Base const &>(*this) != begin_ && !filter_(*static_cast<Base const &>(*this)));
+            } while (!filter()(*static_cast<Base const &>(*this)));
             return *this;
         }
-        constexpr auto operator--(int) noexcept(true)
+        constexpr auto operator--(int) noexcept(nothrow_range<Base>::value)
         {
             auto tmp = *this;
             operator--();
             return (tmp);
         }
 
+        constexpr void settle() noexcept(nothrow_range<Base>::value) {
+            linq::settle(static_cast<Base &>(*this));
+            linq::settle(end_);
+            while (static_cast<Base const &>(*this) != end_ && !filter()(*static_cast<Base const &>(*this)))
+                static_cast<Base &>(*this).operator++();
+        }
+
+        constexpr Filter const &filter() const noexcept(true) { return closure_t::get(); }
+        constexpr closure_t const &closure() const noexcept(true) { return *this; }
+
     private:
-        Base const begin_;
-        Base const end_;
-        Filter const filter_;
+        Base end_;
     };
 
     template<typename BaseIt, typename Filter>
@@ -68,8 +79,13 @@ namespace linq
         Where(Where const &rhs)
                 : base_t(static_cast<base_t const &>(rhs))
         {}
-        Where(BaseIt const &begin, BaseIt const &end, Filter const &filter) noexcept(true)
-                : base_t(iterator(begin, begin, end, filter), iterator(end, begin, end, filter))
+        Where(BaseIt const &begin, BaseIt const &end, Filter const &filter, stage_context const &upstream)
+                : Where(begin, end, hold(filter, upstream))
+        {}
+
+    private:
+        Where(BaseIt const &begin, BaseIt const &end, held_closure<Filter> const &filter) noexcept(true)
+                : base_t(iterator(begin, end, filter), iterator(end, end, filter), filter.context)
         {}
     };
 }
@@ -3,27 +3,91 @@
 #include <utility>
 #include <memory>
 #include <tuple>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+#include <exception>
+#include <numeric>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <system_error>
+#include <string>
+#include <istream>
 
 #include <algorithm>
 #include <unordered_map>
 #include <vector>
+#include <array>
+#include <deque>
 #include <map>
+#include <set>
+
+#if defined(__linux__)
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <fcntl.h>
+# include <unistd.h>
+# include <cerrno>
+#else
+# include <fstream>
+#endif
 
 #ifndef LINQ_H_
 # define LINQ_H_
 # include "linq/Utility.h"
+# include "linq/ThreadPool.h"
+# include "linq/Simd.h"
+# include "linq/Arena.h"
+# include "linq/Hash.h"
 
 namespace linq
 {
     template<typename Iterator>
     class TState;
+    template<typename Iterator>
+    class From;
+    template<typename Handle>
+    class TEnumerable;
+    template<typename Base, typename State>
+    class join_it;
+    template<typename Base, typename State>
+    class group_join_it;
+    template<typename State>
+    class memo_it;
+    template<typename It>
+    struct splitter;
+    template<typename Base>
+    class chunk_it;
 }
 
 # include "linq/All.h"
 # include "linq/Select.h"
 # include "linq/Where.h"
 # include "linq/Take.h"
+# include "linq/Skip.h"
+# include "linq/Distinct.h"
+# include "linq/Range.h"
+# include "linq/File.h"
+# include "linq/Concat.h"
 # include "linq/From.h"
+# include "linq/Push.h"
+# include "linq/Size.h"
+# include "linq/Reduce.h"
+# include "linq/Sort.h"
+# include "linq/Ordered.h"
+# include "linq/Group.h"
+# include "linq/Set.h"
+# include "linq/Join.h"
+# include "linq/Memo.h"
+# include "linq/Soa.h"
+# include "linq/Chunk.h"
+# include "linq/Pipe.h"
+# include "linq/Parallel.h"
 # include "linq/TState.h"
 # include "linq/TEnumerable.h"
 
@@ -42,6 +106,35 @@ namespace linq
         return std::move(TEnumerable<From<T>>(From<T>(begin, end)));
     }
 
+    // columnar sources: over a linq::soa, or over a columnar copy of rows owned by the query
+    template<typename T, typename... Ms>
+    auto make_enumerable_soa(soa<T, Ms...> const &store) {
+        using it_t = soa_it<soa<T, Ms...>>;
+        return TEnumerable<From<it_t>>(From<it_t>(it_t(store, 0), it_t(store, store.size())));
+    }
+    template<typename Container, typename T, typename... Ms>
+    auto make_enumerable_soa(Container const &rows, Ms T::*...members) {
+        using it_t = soa_it<soa<T, Ms...>>;
+        auto const held = std::make_shared<soa<T, Ms...> const>(rows, members...);
+        return TEnumerable<From<it_t>>(From<it_t>(it_t(*held, 0), it_t(*held, held->size()), held));
+    }
+
+    // zero-copy source over a file of T records (a trailing partial record is left out);
+    // options are the mapped_file access hints
+    template<typename T>
+    auto from_mmap(std::string const &path, unsigned const options = mapped_file::sequential | mapped_file::willneed) {
+        static_assert(std::is_trivially_copyable<T>::value, "records are read as raw bytes");
+        using it_t = pointer_it<T const>;
+        auto const held = std::make_shared<mapped_file const>(path, options);
+        auto const data = static_cast<T const *>(held->data());
+        return TEnumerable<From<it_t>>(From<it_t>(it_t(data), it_t(data + held->size() / sizeof(T)), held));
+    }
+    // single-pass source over the T records of a binary stream, which must outlive the query
+    template<typename T>
+    auto from_stream(std::istream &in) {
+        return TEnumerable<From<record_it<T>>>(From<record_it<T>>(record_it<T>(in), record_it<T>()));
+    }
+
     template<typename T>
     auto from(T const &container) {
         return std::move(linq::From<typename T::const_iterator>(std::begin(container), std::end(container)));
@@ -54,6 +147,19 @@ namespace linq
     auto range(T const &begin, T const &end) {
         return std::move(linq::From<T>(begin, end));
     }
+
+    // count values from start, step apart, computed on the fly
+    template<typename T>
+    auto Range(T const &start, std::size_t const count, T const &step = T(1)) {
+        auto const end = static_cast<std::ptrdiff_t>(count);
+        return TEnumerable<From<range_it<T>>>(From<range_it<T>>(range_it<T>(start, step, 0), range_it<T>(start, step, end)));
+    }
+    template<typename T>
+    auto Repeat(T const &value, std::size_t const count) {
+        auto const held = std::make_shared<T const>(value);
+        auto const end = static_cast<std::ptrdiff_t>(count);
+        return TEnumerable<From<repeat_it<T>>>(From<repeat_it<T>>(repeat_it<T>(*held, 0), repeat_it<T>(*held, end), held));
+    }
 }
 
 #endif // !LINQ_H_
@@ -1,6 +1,14 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <cstdlib>
 #include <iostream>
+#include <map>
 #include <ctime>
+#include <unordered_set>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
 
 #include "linq/linq.h"
 #include "assert.h"
@@ -41,12 +49,35 @@ enum class which
     From,
     Take,
     Skip,
+    Deferred,
     All,
     Select,
     Where,
     SelectMany,
     GroupBy,
+    GroupSum,
     OrderBy,
+    TopK,
+    Distinct,
+    Set,
+    Memoize,
+    Arena,
+    Aggregate,
+    Soa,
+    File,
+    Chunk,
+    Prefetch,
+    ParallelOrderBy,
+    ParallelGroupBy,
+    Closure,
+    ParallelTake,
+    ParallelWhere,
+    Range,
+    Repeat,
+    Concat,
+    ByRef,
+    Join,
+    GroupJoin,
     Custom
 
 };
@@ -195,6 +226,242 @@ struct Test<int, which::Where>
                });
     }
 };
+/* Tests the closed forms of generated sources against plain loops over the same values */
+template <typename V>
+std::vector<double> naiveRange(V const start, std::size_t const count, V const step)
+{
+    std::vector<V> values;
+    for (std::size_t i = 0; i < count; ++i)
+        values.push_back(static_cast<V>(start + step * static_cast<V>(i)));
+    std::vector<double> result;
+    V sum{};
+    for (auto const &val : values)
+        sum = static_cast<V>(sum + val);
+    result.push_back(static_cast<double>(sum));
+    result.push_back(static_cast<double>(values.size()));
+    if (!values.empty())
+    {
+        result.push_back(static_cast<double>(*std::min_element(values.begin(), values.end())));
+        result.push_back(static_cast<double>(*std::max_element(values.begin(), values.end())));
+    }
+    // every value is found, every half step between two values is not
+    int hits = 0;
+    for (std::size_t i = 0; i <= count; ++i)
+    {
+        V const probes[] = {static_cast<V>(start + step * static_cast<V>(i)),
+                            static_cast<V>(start + step * static_cast<V>(i) + step / 2)};
+        for (auto const &probe : probes)
+            hits += std::find(values.begin(), values.end(), probe) != values.end();
+    }
+    result.push_back(hits);
+    return result;
+}
+template <typename V>
+std::vector<double> enumRange(V const start, std::size_t const count, V const step)
+{
+    auto const range = linq::Range(start, count, step);
+    std::vector<double> result;
+    result.push_back(static_cast<double>(range.Sum()));
+    result.push_back(static_cast<double>(range.Count()));
+    if (range.Any())
+    {
+        result.push_back(static_cast<double>(range.Min()));
+        result.push_back(static_cast<double>(range.Max()));
+    }
+    int hits = 0;
+    for (std::size_t i = 0; i <= count; ++i)
+    {
+        V const probes[] = {static_cast<V>(start + step * static_cast<V>(i)),
+                            static_cast<V>(start + step * static_cast<V>(i) + step / 2)};
+        for (auto const &probe : probes)
+            hits += range.Contains(probe);
+    }
+    result.push_back(hits);
+    return result;
+}
+// floating sums are folded in another order by the closed form, so they only have to agree closely
+inline bool sameResults(std::vector<double> const &lhs, std::vector<double> const &rhs)
+{
+    if (lhs.size() != rhs.size())
+        return false;
+    for (std::size_t i = 0; i < lhs.size(); ++i)
+        if (std::abs(lhs[i] - rhs[i]) > 1e-5 * std::max(1.0, std::abs(lhs[i])))
+            return false;
+    return true;
+}
+template <>
+struct Test<int, which::Range>
+{
+    auto operator()() const
+    {
+        auto const run = [](auto const &range) {
+            std::vector<double> result;
+            for (auto const &it : {range(0, std::size_t{1000}, 3), range(1000, std::size_t{500}, -7),
+                                   range(-20, std::size_t{1}, 5), range(7, std::size_t{0}, 3)})
+                result.insert(result.end(), it.begin(), it.end());
+            for (auto const &it : {range(0.5, std::size_t{1000}, 0.1), range(10.0, std::size_t{200}, -0.25),
+                                   range(1.0, std::size_t{300}, 1.0 / 3), range(2.5, std::size_t{50}, 0.0)})
+                result.insert(result.end(), it.begin(), it.end());
+            for (auto const &it : {range(0.1f, std::size_t{1000}, 0.1f), range(3.0f, std::size_t{400}, -0.3f)})
+                result.insert(result.end(), it.begin(), it.end());
+            for (auto const &it : {range(5u, std::size_t{1000}, 2u), range(4000000000u, std::size_t{100}, 1u),
+                                   range(9u, std::size_t{0}, 1u)})
+                result.insert(result.end(), it.begin(), it.end());
+            return result;
+        };
+        std::cout << SEPARATOR_TEST << std::endl;
+        auto const naive = test("Naive->Range", [&]() {
+            return run([](auto const start, std::size_t const count, auto const step) {
+                return naiveRange(start, count, step);
+            });
+        });
+        return sameResults(naive, test("IEnum->Range", [&]() {
+            return run([](auto const start, std::size_t const count, auto const step) {
+                return enumRange(start, count, step);
+            });
+        }));
+    }
+};
+template <>
+struct Test<int, which::Repeat>
+{
+    auto operator()() const
+    {
+        auto const run = [](auto const &repeat) {
+            std::vector<double> result;
+            for (auto const &it : {repeat(7, std::size_t{1000}), repeat(-3, std::size_t{1}), repeat(5, std::size_t{0})})
+                result.insert(result.end(), it.begin(), it.end());
+            for (auto const &it : {repeat(0.1, std::size_t{1000}), repeat(2.5, std::size_t{0})})
+                result.insert(result.end(), it.begin(), it.end());
+            return result;
+        };
+        std::cout << SEPARATOR_TEST << std::endl;
+        auto const naive = test("Naive->Repeat", [&]() {
+            return run([](auto const value, std::size_t const count) {
+                std::vector<double> result;
+                typename std::decay<decltype(value)>::type sum{};
+                for (std::size_t i = 0; i < count; ++i)
+                    sum += value;
+                result.push_back(static_cast<double>(sum));
+                result.push_back(static_cast<double>(count));
+                if (count)
+                {
+                    result.push_back(static_cast<double>(value));
+                    result.push_back(static_cast<double>(value));
+                }
+                result.push_back(count != 0);
+                result.push_back(false);
+                return result;
+            });
+        });
+        return sameResults(naive, test("IEnum->Repeat", [&]() {
+            return run([](auto const value, std::size_t const count) {
+                auto const repeat = linq::Repeat(value, count);
+                std::vector<double> result;
+                result.push_back(static_cast<double>(repeat.Sum()));
+                result.push_back(static_cast<double>(repeat.Count()));
+                if (repeat.Any())
+                {
+                    result.push_back(static_cast<double>(repeat.Min()));
+                    result.push_back(static_cast<double>(repeat.Max()));
+                }
+                result.push_back(repeat.Contains(value));
+                result.push_back(repeat.Contains(value + 1));
+                return result;
+            });
+        }));
+    }
+};
+/* Tests Concat positions on both sides of the seam */
+template <>
+struct Test<int, which::Concat>
+{
+    auto operator()() const
+    {
+        Context<int> context;
+        auto &data = context.get();
+        std::vector<int> const first(data.begin(), data.begin() + 1000);
+        std::vector<int> const second(data.begin() + 1000, data.begin() + 1500);
+        std::vector<int> const none;
+        std::size_t const seam = first.size();
+
+        return test("Naive->Concat", [&]() {
+            std::vector<long long> result;
+            std::vector<int> all(first);
+            all.insert(all.end(), second.begin(), second.end());
+            result.push_back(static_cast<long long>(all.size()));
+            for (auto const at : {std::size_t{0}, seam - 1, seam, seam + 1, all.size() - 1})
+                result.push_back(all[at]);
+            result.push_back(all.back());
+            // random access: forward over the seam, back over it, indexed and distance
+            result.push_back(all[seam + 5]);
+            result.push_back(all[seam - 5]);
+            result.push_back(all[seam - 5 + 3]);
+            result.push_back(static_cast<long long>(all.size()));
+            result.push_back(all[all.size() - 1]);
+            // size hints: exact over plain sides, an upper bound behind a filter
+            result.push_back(static_cast<long long>(all.size()));
+            result.push_back(true);
+            long long odd = 0;
+            for (auto const &val : all)
+                odd += val % 2;
+            result.push_back(true);
+            result.push_back(false);
+            result.push_back(odd);
+            // an empty first side
+            result.push_back(static_cast<long long>(second.size()));
+            result.push_back(second.front());
+            result.push_back(second.back());
+            // generated sides
+            std::vector<int> generated;
+            for (int i = 0; i < 100; ++i)
+                generated.push_back(i);
+            generated.insert(generated.end(), 50, 7);
+            result.push_back(static_cast<long long>(generated.size()));
+            result.push_back(generated[99]);
+            result.push_back(generated[100]);
+            result.push_back(generated.back());
+            return result;
+        })
+               ==
+               test("IEnum->Concat", [&]() {
+                   std::vector<long long> result;
+                   auto const all = linq::make_enumerable(first).Concat(linq::make_enumerable(second));
+                   result.push_back(static_cast<long long>(all.Count()));
+                   for (auto const at : {std::size_t{0}, seam - 1, seam, seam + 1, seam + second.size() - 1})
+                       result.push_back(all.ElementAt(at));
+                   result.push_back(all.Last());
+                   auto it = all.begin();
+                   it += static_cast<std::ptrdiff_t>(seam + 5);
+                   result.push_back(*it);
+                   it -= 10;
+                   result.push_back(*it);
+                   result.push_back(it[3]);
+                   result.push_back(all.end() - all.begin());
+                   result.push_back(*(all.end() - 1));
+                   auto const hint = linq::size_range(all.begin(), all.end());
+                   result.push_back(static_cast<long long>(hint.size));
+                   result.push_back(hint.exact);
+                   auto const odd = linq::make_enumerable(first).Where([](int val) noexcept(true) { return val % 2; })
+                           .Concat(linq::make_enumerable(second).Where([](int val) noexcept(true) { return val % 2; }));
+                   auto const bound = linq::size_range(odd.begin(), odd.end());
+                   auto const kept = odd.Count();
+                   result.push_back(bound.size >= kept && bound.size <= seam + second.size());
+                   result.push_back(bound.exact);
+                   result.push_back(static_cast<long long>(kept));
+                   auto const tail = linq::make_enumerable(none).Concat(linq::make_enumerable(second));
+                   result.push_back(static_cast<long long>(tail.Count()));
+                   result.push_back(tail.ElementAt(0));
+                   result.push_back(tail.Last());
+                   auto const generated = linq::Range(0, 100).Concat(linq::Repeat(7, 50));
+                   result.push_back(static_cast<long long>(generated.Count()));
+                   result.push_back(generated.ElementAt(99));
+                   result.push_back(generated.ElementAt(100));
+                   result.push_back(generated.Last());
+                   return result;
+               });
+    }
+};
 /* Tests enum vs complexe vector<object>*/
 template <typename T>
 struct Test<T, which::Select>
@@ -274,13 +541,57 @@ struct Test<T, which::Skip>
     }
 };
 template <typename T>
+struct Test<T, which::Deferred>
+{
+    auto operator()() const
+    {
+        Context<T> context;
+        auto &data = context.get();
+
+        return test("Naive->Deferred", [&]() noexcept(true) {
+            long result = 0;
+            int seen = 0;
+            for (const auto &it : data)
+                if (it.likes % 2 && seen++ >= 1000) {
+                    if (seen > 1010 && seen <= 1510)
+                        result += it.visits;
+                    if (it.id >= 50)
+                        ++result;
+                }
+            return result;
+        })
+               ==
+               test("IEnum->Deferred", [&]() {
+                   // building the query walks nothing, the filter first runs in Sum
+                   // the parallel Count runs the filter on the pool threads
+                   std::atomic<std::size_t> calls(0);
+                   auto const odd = [&calls](const auto &usr) noexcept(true) { ++calls; return usr.likes % 2 == 1; };
+                   auto const rows = linq::make_enumerable(data)
+                           .Where(odd)
+                           .Skip(1000)
+                           .All()
+                           .Skip(10)
+                           .Take(500)
+                           .Select([](const auto &usr) noexcept(true) { return static_cast<long>(usr.visits); });
+                   auto const parallel = linq::make_enumerable(data)
+                           .Where(odd)
+                           .AsParallel(4)
+                           .Skip(1000)
+                           .SkipWhile([](const auto &usr) noexcept(true) { return usr.id < 50; });
+                   if (calls)
+                       return 0l;
+                   return rows.Sum() + static_cast<long>(parallel.Count());
+               });
+    }
+};
+template <typename T>
 struct Test<T, which::Where>
 {
     auto operator()() const
     {
         Context<T> context;
         auto &data = context.get();
-        return test("Naive->Where", [&]() {
+        auto const filtered = test("Naive->Where", [&]() {
             int result = 0;
             for (const auto &it : data)
             {
@@ -297,6 +608,26 @@ struct Test<T, which::Where>
                            .Where([](const auto &val) noexcept(true) { return val > 1234; })
                            .Sum();
                });
+
+        // the filtered Min/Max kernel reaches the infinities
+        auto const infinite = test("IEnum->WhereInfinity", [&]() {
+            double const inf = std::numeric_limits<double>::infinity();
+            std::vector<double> const high(3, inf), low(3, -inf);
+            auto const any = [](double) noexcept(true) { return true; };
+            return linq::make_enumerable(high).Where(any).Min() == inf
+                   && linq::make_enumerable(low).Where(any).Max() == -inf;
+        });
+        // the backward walk of Last stops at the one match, at the front of the source
+        auto const last = test("IEnum->WhereLast", [&]() {
+            auto const first = data.front().id;
+            auto const source = linq::make_enumerable(data);
+            auto const front = source.Where([first](const auto &usr) noexcept(true) { return usr.id == first; });
+            auto const none = source.Where([](const auto &usr) noexcept(true) { return usr.likes < 0; })
+                    .Select([](const auto &usr) noexcept(true) { return usr.id + 1; });
+            return front.Last().id == first && front.Select([](const auto &usr) noexcept(true) { return usr.id; }).Last() == first
+                   && none.LastOrDefault() == 0 && none.Reverse().Count() == 0;
+        });
+        return filtered && infinite && last;
     }
 };
 template <typename T>
@@ -373,6 +704,36 @@ struct CustomFilterAsc
     }
 };
 
+template <typename T>
+struct Test<T, which::GroupSum>
+{
+    auto operator()() const
+    {
+        Context<T> context;
+        auto &data = context.get();
+        // the sums are compared group by group (a key emitted twice shows up too), not only their total
+        return test("Naive->GroupSum", [&]() {
+            std::unordered_map<int, std::vector<T>> groups;
+            std::map<int, int> result;
+            for (const auto &it : data)
+                groups[it.group].push_back(it);
+            for (const auto &it : groups)
+                for (const auto &usr : it.second)
+                    result[it.first] += usr.likes;
+            return std::vector<std::pair<int, int>>(result.begin(), result.end());
+        })
+               ==
+               test("IEnum->GroupSum", [&]() {
+                   std::vector<std::pair<int, int>> result;
+                   linq::make_enumerable(data)
+                           .GroupBy([](const auto &key) noexcept(true) { return key.group; })
+                           .Aggregate(0, [](int acc, const auto &usr) noexcept(true) { return acc + usr.likes; })
+                           .Each([&result](auto const &pair) { result.emplace_back(pair.first, pair.second); });
+                   std::sort(result.begin(), result.end());
+                   return result;
+               });
+    }
+};
 template <typename T>
 struct Test<T, which::OrderBy>
 {
@@ -410,6 +771,1008 @@ struct Test<T, which::OrderBy>
     }
 };
 template <typename T>
+struct Test<T, which::ByRef>
+{
+    auto operator()() const
+    {
+        Context<T> context;
+        auto &data = context.get();
+
+        return test("Naive->ByRef", [&]() {
+            std::vector<T> sorted(data.begin(), data.end());
+            std::sort(sorted.begin(), sorted.end(), [](T const &l, T const &r) {
+                return std::make_tuple(l.group, -l.likes, l.id) < std::make_tuple(r.group, -r.likes, r.id);
+            });
+            std::vector<int> order, all;
+            for (auto const &usr : sorted)
+                order.push_back(usr.id);
+            for (auto const &usr : data)
+                all.push_back(usr.id);
+            std::vector<std::pair<int, int>> unsorted;
+            for (auto const &usr : data)
+                unsorted.emplace_back(usr.category, usr.id);
+            auto rows = unsorted;
+            std::sort(rows.begin(), rows.end());
+            return std::make_tuple(order, order, all, rows, rows, unsorted, true);
+        })
+               ==
+               test("IEnum->ByRef", [&]() {
+                   auto const source = linq::make_enumerable(data);
+                   auto const group = linq::asc([](const auto &usr) noexcept(true) { return usr.group; });
+                   auto const likes = linq::desc([](const auto &usr) noexcept(true) { return usr.likes; });
+                   auto const id = linq::asc([](const auto &usr) noexcept(true) { return usr.id; });
+                   std::vector<int> copied, order, all;
+                   for (auto const &usr : source.OrderBy(group, likes, id))
+                       copied.push_back(usr.id);
+                   // by_ref rows are the source rows themselves: ids are positions in data
+                   bool aliased = true;
+                   for (auto const &usr : source.OrderBy(linq::by_ref, group, likes, id))
+                   {
+                       order.push_back(usr.id);
+                       aliased &= std::addressof(usr) == std::addressof(data[usr.id]);
+                   }
+                   for (auto const &usr : source.All(linq::by_ref))
+                   {
+                       all.push_back(usr.id);
+                       aliased &= std::addressof(usr) == std::addressof(data[usr.id]);
+                   }
+                   // rows computed on the fly have nothing to point to and are stored as copies
+                   auto const computed = source.Select([](const auto &usr) noexcept(true) {
+                       return std::make_pair(usr.category, usr.id);
+                   });
+                   auto const pair = linq::asc([](const auto &row) noexcept(true) { return row; });
+                   std::vector<std::pair<int, int>> rows, fallback;
+                   for (auto const &row : computed.OrderBy(pair))
+                       rows.push_back(row);
+                   for (auto const &row : computed.OrderBy(linq::by_ref, pair))
+                       fallback.push_back(row);
+                   std::vector<std::pair<int, int>> unsorted;
+                   for (auto const &row : computed.All(linq::by_ref))
+                       unsorted.push_back(row);
+                   return std::make_tuple(copied, order, all, rows, fallback, unsorted, aliased);
+               });
+    }
+};
+template <typename T>
+struct Test<T, which::TopK>
+{
+    auto operator()() const
+    {
+        Context<T> context;
+        auto &data = context.get();
+
+        return test("Naive->TopK", [&]() noexcept(true) {
+            std::uint64_t result = 0;
+            std::partial_sort(data.begin(), data.begin() + 100, data.end(), [](T const &l, T const &r)
+            {
+                return l.likes > r.likes || (l.likes == r.likes && l.id < r.id);
+            });
+            for (auto it = data.begin(); it != data.begin() + 100; ++it)
+                result = result * 31 + it->id;
+
+            return result;
+        })
+               ==
+               test("IEnum->TopK", [&]() {
+                   std::uint64_t result = 0;
+                   linq::make_enumerable(data)
+                           .OrderBy(linq::desc([](const auto &key) noexcept(true) { return key.likes; }),
+                                    linq::asc([](const auto &key) noexcept(true) { return key.id; }))
+                           .Take(100)
+                           .Each([&result](const auto &it) { result = result * 31 + it.id; });
+                   return result;
+               });
+    }
+};
+template <typename T>
+struct Test<T, which::Distinct>
+{
+    auto operator()() const
+    {
+        Context<T> context;
+        auto &data = context.get();
+
+        auto const expected = test("Naive->Distinct", [&]() noexcept(true) {
+            std::uint64_t result = 0;
+            std::unordered_set<int> seen;
+            for (auto const &it : data)
+                if (seen.insert(it.likes).second)
+                    result = result * 31 + it.likes;
+            return result;
+        });
+        auto const computed = test("IEnum->Distinct", [&]() {
+            std::uint64_t result = 0;
+            linq::make_enumerable(data)
+                    .Select([](const auto &key) noexcept(true) { return key.likes; })
+                    .Distinct()
+                    .Each([&result](int const likes) { result = result * 31 + likes; });
+            return result;
+        });
+        // the query handle is gone, the iterators keep the state they share
+        auto const detached = test("IEnum->DistinctDetached", [&]() {
+            auto range = [&data]() {
+                auto const query = linq::make_enumerable(data)
+                        .Select([](const auto &key) noexcept(true) { return key.likes; })
+                        .Distinct();
+                return std::make_pair(query.begin(), query.end());
+            }();
+            std::uint64_t result = 0;
+            for (; range.first != range.second; ++range.first)
+                result = result * 31 + *range.first;
+            return result;
+        });
+        // enumerations of one handle on several threads share its memo
+        auto const shared = test("IEnum->DistinctShared", [&]() {
+            auto const query = linq::make_enumerable(data)
+                    .Select([](const auto &key) noexcept(true) { return key.likes; })
+                    .Distinct();
+            std::array<std::uint64_t, 4> results{};
+            std::vector<std::thread> threads;
+            for (auto &result : results)
+                threads.emplace_back([&query, &result]() {
+                    query.Each([&result](int const likes) { result = result * 31 + likes; });
+                });
+            for (auto &thread : threads)
+                thread.join();
+            return std::all_of(results.begin(), results.end(), [&results](std::uint64_t const result) {
+                return result == results.front();
+            }) ? results.front() : 0;
+        });
+        return expected == computed && expected == detached && expected == shared;
+    }
+};
+template <typename T>
+struct Test<T, which::Set>
+{
+    auto operator()() const
+    {
+        Context<T> context;
+        auto &data = context.get();
+        std::vector<int> left, right;
+        for (auto const &it : data) {
+            if (left.size() < 50000)
+                left.push_back(it.likes);
+            right.push_back(it.visits % 10000);
+        }
+        std::string const leftBytes(reinterpret_cast<char const *>(left.data()), left.size() * sizeof(int));
+        std::string const rightBytes(reinterpret_cast<char const *>(right.data()), right.size() * sizeof(int));
+
+        // Union, Intersect and Except of both orders, rows in order of first occurrence
+        auto const checksum = [](auto const &rows) noexcept(true) {
+            std::uint64_t result = 0;
+            for (auto const it : rows)
+                result = result * 31 + static_cast<std::uint64_t>(it);
+            return result;
+        };
+        auto const naive = [&checksum](std::vector<int> const &lhs, std::vector<int> const &rhs) {
+            std::unordered_set<int> const inRhs(rhs.begin(), rhs.end());
+            std::unordered_set<int> united, kept;
+            std::vector<int> unite, intersect, except;
+            for (auto const it : lhs)
+                if (united.insert(it).second)
+                    unite.push_back(it);
+            for (auto const it : rhs)
+                if (united.insert(it).second)
+                    unite.push_back(it);
+            for (auto const it : lhs)
+                if (kept.insert(it).second)
+                    (inRhs.count(it) ? intersect : except).push_back(it);
+            return checksum(unite) + 3 * checksum(intersect) + 7 * checksum(except);
+        };
+        auto const query = [&checksum](auto const &lhs, auto const &rhs) {
+            return checksum(lhs.Union(rhs)) + 3 * checksum(lhs.Intersect(rhs)) + 7 * checksum(lhs.Except(rhs));
+        };
+
+        auto const expected = test("Naive->Set", [&]() {
+            return naive(left, right) + naive(right, left);
+        });
+        auto const computed = test("IEnum->Set", [&]() {
+            return query(linq::make_enumerable(left), linq::make_enumerable(right))
+                   + query(linq::make_enumerable(right), linq::make_enumerable(left));
+        });
+        // single-pass sides of unknown size: the left one is streamed once, against the hashed
+        // right one
+        auto const streamed = test("IEnum->SetStream", [&]() {
+            std::uint64_t result = 0, weight = 1;
+            for (int op = 0; op < 3; ++op, weight += 2 * op) {
+                std::istringstream lhsIn(leftBytes), rhsIn(rightBytes);
+                auto const lhs = linq::from_stream<int>(lhsIn);
+                auto const rhs = linq::from_stream<int>(rhsIn);
+                result += weight * (op == 0 ? checksum(lhs.Union(rhs)) : op == 1 ? checksum(lhs.Intersect(rhs)) : checksum(lhs.Except(rhs)));
+            }
+            return result;
+        });
+        return expected == computed && expected - naive(right, left) == streamed;
+    }
+};
+template <typename T>
+struct Test<T, which::Memoize>
+{
+    auto operator()() const
+    {
+        Context<T> context;
+        auto &data = context.get();
+
+        auto const expected = test("Naive->Memoize", [&]() noexcept(true) {
+            std::vector<int> scores;
+            for (auto const &it : data)
+                if (it.visits % 3)
+                    scores.push_back(it.likes * it.visits % 1009);
+            int best = 0;
+            long total = 0;
+            for (auto const score : scores) {
+                best = std::max(best, score);
+                total += score;
+            }
+            return static_cast<long>(scores.size()) + best + total;
+        });
+        auto const query = [&data]() {
+            return linq::make_enumerable(data)
+                    .Where([](const auto &usr) noexcept(true) { return usr.visits % 3; })
+                    .Select([](const auto &usr) noexcept(true) { return usr.likes * usr.visits % 1009; })
+                    .Memoize();
+        };
+        auto const computed = test("IEnum->Memoize", [&]() {
+            auto const scores = query();
+            long total = 0;
+            scores.Each([&total](int const score) { total += score; });
+            return static_cast<long>(scores.Count()) + scores.Max() + total;
+        });
+        // the query handle is gone, the iterators keep the memo
+        auto const detached = test("IEnum->MemoizeDetached", [&]() {
+            auto range = [&query]() {
+                auto const scores = query();
+                return std::make_pair(scores.begin(), scores.end());
+            }();
+            long count = 0, total = 0;
+            int best = 0;
+            for (; range.first != range.second; ++range.first, ++count) {
+                best = std::max(best, *range.first);
+                total += *range.first;
+            }
+            return count + best + total;
+        });
+        // rows are computed once, whoever reads them first
+        auto const counted = [&data](std::atomic<std::size_t> &calls) {
+            return linq::make_enumerable(data)
+                    .Where([](const auto &usr) noexcept(true) { return usr.visits % 3; })
+                    .Select([&calls](const auto &usr) noexcept(true) { ++calls; return usr.likes * usr.visits % 1009; })
+                    .Memoize();
+        };
+        auto const summary = [](auto it, auto const &end) {
+            long count = 0, total = 0;
+            int best = 0;
+            for (; it != end; ++it, ++count) {
+                best = std::max(best, *it);
+                total += *it;
+            }
+            return count + best + total;
+        };
+        auto const shared = test("IEnum->MemoizeShared", [&]() {
+            std::atomic<std::size_t> calls(0);
+            auto const scores = counted(calls);
+            std::vector<long> results(4);
+            std::vector<std::thread> readers;
+            for (std::size_t i = 0; i < results.size(); ++i)
+                readers.emplace_back([&, i]() { results[i] = summary(scores.begin(), scores.end()); });
+            for (auto &reader : readers)
+                reader.join();
+            auto const rows = static_cast<std::size_t>(scores.Count());
+            return std::all_of(results.begin(), results.end(), [&](long const result) { return result == expected; })
+                   && calls == rows;
+        });
+        // a reader that stopped early leaves the memo filled that far, the next one resumes there
+        auto const resumed = test("IEnum->MemoizeResume", [&]() {
+            std::atomic<std::size_t> calls(0);
+            auto const scores = counted(calls);
+            auto it = scores.begin();
+            for (int i = 0; i < 10 && it != scores.end(); ++i, ++it);
+            auto const partial = calls.load();
+            auto const full = summary(scores.begin(), scores.end());
+            return partial <= 10 && full == expected && calls == static_cast<std::size_t>(scores.Count());
+        });
+        return expected == computed && expected == detached && shared && resumed;
+    }
+};
+template <typename T>
+struct Test<T, which::Arena>
+{
+    auto operator()() const
+    {
+        Context<T> context;
+        auto &data = context.get();
+
+        // the same rows in the same order, whichever allocator stored them
+        auto const run = [&data](auto const &...alloc) {
+            auto const digest = [](auto const &rows) {
+                long result = 0, rank = 0;
+                for (const auto &it : rows)
+                    result += (rank++ % 97) * it.visits;
+                return result;
+            };
+            auto const source = linq::make_enumerable(data);
+            std::vector<std::pair<int, int>> groups;
+            source.GroupBy(alloc..., [](const auto &usr) noexcept(true) { return usr.group; })
+                    .Aggregate(0, [](int acc, const auto &usr) noexcept(true) { return acc + usr.likes; })
+                    .Each([&groups](auto const &pair) { groups.emplace_back(pair.first, pair.second); });
+            std::sort(groups.begin(), groups.end());
+            return std::make_tuple(digest(source.All(alloc...)),
+                                   digest(source.OrderBy(alloc..., linq::asc([](const auto &usr) noexcept(true) { return usr.group; }),
+                                                         linq::desc([](const auto &usr) noexcept(true) { return usr.likes; }))),
+                                   groups);
+        };
+        auto const expected = test("IEnum->ArenaDefault", [&]() { return run(); });
+        auto const arena = linq::make_arena();
+        auto const reserved = arena->reserved();
+        auto const computed = test("IEnum->Arena", [&]() { return run(linq::arena_allocator<char>(arena)); });
+        return expected == computed && arena->reserved() > reserved;
+    }
+};
+template <typename T>
+struct Test<T, which::Aggregate>
+{
+    auto operator()() const
+    {
+        Context<T> context;
+        auto &data = context.get();
+
+        auto const reduced = test("Naive->Aggregate", [&]() noexcept(true) {
+            long total = 0;
+            int low = std::numeric_limits<int>::max(), high = std::numeric_limits<int>::lowest();
+            long count = 0;
+            double sum = 0;
+            std::pair<int, int> first, last;
+            for (auto const &it : data)
+                if (it.visits > 100) {
+                    total += it.likes;
+                    low = std::min(low, it.likes);
+                    high = std::max(high, it.likes);
+                    sum += it.likes;
+                    std::pair<int, int> const row(it.group, it.id);
+                    first = !count || row < first ? row : first;
+                    last = !count || last < row ? row : last;
+                    ++count;
+                }
+            return std::make_tuple(total + low + high + count, count ? sum / count : 0.0, first, last);
+        })
+               ==
+               test("IEnum->Aggregate", [&]() {
+                   auto const kept = linq::make_enumerable(data)
+                           .Where([](const auto &usr) noexcept(true) { return usr.visits > 100; });
+                   auto const stats = kept
+                           .Select([](const auto &usr) noexcept(true) { return usr.likes; })
+                           .Aggregate(linq::agg::sum, linq::agg::min, linq::agg::max, linq::agg::count, linq::agg::avg);
+                   // pairs are not arithmetic: min and max keep the first row and compare with <
+                   auto const rows = kept
+                           .Select([](const auto &usr) noexcept(true) { return std::make_pair(usr.group, usr.id); })
+                           .Aggregate(linq::agg::min, linq::agg::max);
+                   return std::make_tuple(static_cast<long>(std::get<0>(stats)) + std::get<1>(stats) + std::get<2>(stats)
+                                          + static_cast<long>(std::get<3>(stats)),
+                                          std::get<4>(stats), std::get<0>(rows), std::get<1>(rows));
+               });
+
+        // floating extrema reach the infinities
+        auto const infinite = test("IEnum->AggregateInfinity", [&]() {
+            double const inf = std::numeric_limits<double>::infinity();
+            std::vector<double> const high(3, inf), low(3, -inf);
+            auto const up = linq::make_enumerable(high).Aggregate(linq::agg::min, linq::agg::max);
+            auto const down = linq::make_enumerable(low)
+                    .Select([](double const val) noexcept(true) { return val; })
+                    .Aggregate(linq::agg::min, linq::agg::max);
+            return up == std::make_tuple(inf, inf) && down == std::make_tuple(-inf, -inf);
+        });
+        return reduced && infinite;
+    }
+};
+// a default-constructible row, so that columnar rows can be rebuilt from the stored members
+struct Stat
+{
+    int group;
+    int likes;
+    int visits;
+};
+
+template <typename T>
+struct Test<T, which::Soa>
+{
+    auto operator()() const
+    {
+        Context<T> context;
+        auto &data = context.get();
+        auto const columns = linq::make_soa(data, &T::likes, &T::visits);
+
+        auto const scan = test("Naive->Soa", [&]() noexcept(true) {
+            long result = 0;
+            for (auto const &it : data)
+                if (it.likes > 100)
+                    result += it.likes;
+            return result;
+        })
+               ==
+               test("IEnum->Soa", [&]() {
+                   return linq::make_enumerable_soa(columns)
+                           .Select(&T::likes)
+                           .Where([](int const likes) noexcept(true) { return likes > 100; })
+                           .Select([](int const likes) noexcept(true) { return static_cast<long>(likes); })
+                           .Sum();
+               });
+
+        // a filter on the row proxies, then a second column
+        auto const proxies = test("Naive->SoaWhere", [&]() noexcept(true) {
+            long result = 0;
+            for (auto const &it : data)
+                if (it.likes > 100)
+                    result += it.visits;
+            return result;
+        })
+               ==
+               test("IEnum->SoaWhere", [&]() {
+                   return linq::make_enumerable_soa(columns)
+                           .Where([](auto const &row) { return row[&T::likes] > 100; })
+                           .Select(&T::visits)
+                           .Select([](int const visits) noexcept(true) { return static_cast<long>(visits); })
+                           .Sum();
+               });
+
+        // full rows rebuilt from the stored members, the others left to their default
+        std::vector<Stat> stats;
+        stats.reserve(data.size());
+        for (auto const &it : data)
+            stats.push_back(Stat{ it.group, it.likes, it.visits });
+        auto const rows = test("Naive->SoaRows", [&]() noexcept(true) {
+            long result = 0;
+            for (auto const &it : stats)
+                result += it.likes * 3L + it.visits;
+            return result;
+        })
+               ==
+               test("IEnum->SoaRows", [&]() {
+                   return linq::make_enumerable_soa(stats, &Stat::likes, &Stat::visits)
+                           .Select([](auto const &row) {
+                               Stat const stat = row;
+                               return stat.likes * 3L + stat.visits + stat.group;
+                           })
+                           .Sum();
+               });
+
+        // a member of a stored type that was not listed
+        bool missing = false;
+        try {
+            auto const only = linq::make_enumerable_soa(stats, &Stat::likes);
+            (void) (*only.begin())[&Stat::visits];
+        } catch (std::out_of_range const &) {
+            missing = true;
+        }
+        // and bound as the key of a stage, when it is built
+        int unbound = 0;
+        auto const only = linq::make_enumerable_soa(stats, &Stat::likes);
+        try {
+            (void) only.Where(&Stat::visits);
+        } catch (std::out_of_range const &) {
+            ++unbound;
+        }
+        try {
+            (void) only.Select(&Stat::visits);
+        } catch (std::out_of_range const &) {
+            ++unbound;
+        }
+        return scan && proxies && rows && missing && unbound == 2;
+    }
+};
+template <typename T>
+struct Test<T, which::File>
+{
+    auto operator()() const
+    {
+        Context<T> context;
+        auto &data = context.get();
+        char const *path = "linq_overhead.bin";
+        {
+            std::ofstream out(path, std::ios::binary);
+            out.write(reinterpret_cast<char const *>(data.data()), static_cast<std::streamsize>(data.size() * sizeof(T)));
+        }
+
+        auto const naive = test("Naive->File", [&]() noexcept(true) {
+            long result = 0;
+            for (auto const &it : data)
+                if (it.likes > 100)
+                    result += it.visits;
+            return result;
+        });
+        auto const mapped = test("IEnum->Mmap", [&]() {
+            return linq::from_mmap<T>(path)
+                    .Where([](const auto &usr) noexcept(true) { return usr.likes > 100; })
+                    .Select([](const auto &usr) noexcept(true) { return static_cast<long>(usr.visits); })
+                    .Sum();
+        });
+        auto const streamed = test("IEnum->Stream", [&]() {
+            std::ifstream in(path, std::ios::binary);
+            return linq::from_stream<T>(in)
+                    .Where([](const auto &usr) noexcept(true) { return usr.likes > 100; })
+                    .Select([](const auto &usr) noexcept(true) { return static_cast<long>(usr.visits); })
+                    .Sum();
+        });
+        // a stream that throws at its end ends the range there
+        auto const throwing = test("IEnum->StreamThrow", [&]() {
+            std::ifstream in(path, std::ios::binary);
+            in.exceptions(std::ios::failbit | std::ios::badbit);
+            return linq::from_stream<T>(in)
+                    .Where([](const auto &usr) noexcept(true) { return usr.likes > 100; })
+                    .Select([](const auto &usr) noexcept(true) { return static_cast<long>(usr.visits); })
+                    .Sum();
+        });
+        // the first record is read once, however many times the terminal asks for begin()
+        auto const head = test("IEnum->StreamFirst", [&]() {
+            std::ifstream in(path, std::ios::binary);
+            auto const rows = linq::from_stream<T>(in);
+            return rows.Any() ? rows.First().id : -1;
+        });
+        // grouped rows of a stream are copies: the iterator reads every record into the same slot
+        auto const naiveGroups = test("Naive->StreamGroupBy", [&]() {
+            std::unordered_map<int, std::vector<int>> groups;
+            for (auto const &it : data)
+                groups[it.group].push_back(it.id);
+            std::vector<std::pair<int, std::vector<int>>> result(groups.begin(), groups.end());
+            std::sort(result.begin(), result.end());
+            return result;
+        });
+        auto const streamedGroups = test("IEnum->StreamGroupBy", [&]() {
+            std::ifstream in(path, std::ios::binary);
+            std::vector<std::pair<int, std::vector<int>>> result;
+            for (auto const &group : linq::from_stream<T>(in).GroupBy(&T::group))
+            {
+                std::vector<int> ids;
+                for (auto const &usr : group.second)
+                    ids.push_back(usr.id);
+                result.emplace_back(group.first, ids);
+            }
+            std::sort(result.begin(), result.end());
+            return result;
+        });
+        std::remove(path);
+        return naive == mapped && naive == streamed && naive == throwing && head == data.front().id && naiveGroups == streamedGroups;
+    }
+};
+template <typename T>
+struct Test<T, which::Chunk>
+{
+    auto operator()() const
+    {
+        Context<T> context;
+        auto &data = context.get();
+
+        auto const naive = test("Naive->Chunk", [&]() noexcept(true) {
+            long result = 0;
+            std::vector<int> batch;
+            batch.reserve(256);
+            auto const flush = [&]() {
+                result += static_cast<long>(batch.size()) * *std::max_element(batch.begin(), batch.end());
+                batch.clear();
+            };
+            for (auto const &it : data) {
+                if (it.likes > 100)
+                    batch.push_back(it.visits);
+                if (batch.size() == 256)
+                    flush();
+            }
+            if (!batch.empty())
+                flush();
+            return result;
+        });
+        auto const spans = test("IEnum->Chunk", [&]() {
+            long result = 0;
+            linq::make_enumerable(data)
+                    .Chunk(1024)
+                    .Each([&result](auto const &rows) {
+                        for (auto const &usr : rows)
+                            if (usr.likes > 100)
+                                result += usr.visits;
+                    });
+            return result;
+        });
+        auto const buffered = test("IEnum->Chunk(Where)", [&]() {
+            long result = 0;
+            linq::make_enumerable(data)
+                    .Where([](const auto &usr) noexcept(true) { return usr.likes > 100; })
+                    .Select([](const auto &usr) noexcept(true) { return usr.visits; })
+                    .Chunk(256)
+                    .Each([&result](auto const &visits) {
+                        result += static_cast<long>(visits.size()) * linq::make_enumerable(visits).Max();
+                    });
+            return result;
+        });
+        long sum = 0;
+        for (auto const &it : data)
+            if (it.likes > 100)
+                sum += it.visits;
+        return naive == buffered && spans == sum;
+    }
+};
+template <typename T>
+struct Test<T, which::Prefetch>
+{
+    auto operator()() const
+    {
+        Context<T> context;
+        auto &data = context.get();
+
+        auto const naive = test("Naive->Prefetch", [&]() noexcept(true) {
+            long result = 0;
+            for (auto const &it : data) {
+                auto const score = it.likes * 31 + it.visits;
+                if (score % 7)
+                    result += score;
+            }
+            return result;
+        });
+        auto const pipelined = test("IEnum->Prefetch", [&]() {
+                   return linq::make_enumerable(data)
+                           .Select([](const auto &usr) noexcept(true) { return static_cast<long>(usr.likes * 31 + usr.visits); })
+                           .Prefetch(256)
+                           .Where([](long const score) noexcept(true) { return score % 7; })
+                           .Sum();
+               });
+        // *it++ reads the row of before the increment
+        auto const postfix = test("IEnum->PrefetchPostfix", [&]() {
+                   auto const rows = linq::make_enumerable(data)
+                           .Select([](const auto &usr) noexcept(true) { return static_cast<long>(usr.likes * 31 + usr.visits); })
+                           .Prefetch(256);
+                   long result = 0;
+                   for (auto it = rows.begin(); it != rows.end();) {
+                       auto const score = *it++;
+                       if (score % 7)
+                           result += score;
+                   }
+                   return result;
+               });
+        // every enumeration of a handle over a Prefetch stage runs its own pipeline
+        auto const twice = test("IEnum->PrefetchTwice", [&]() {
+                   auto const rows = linq::make_enumerable(data)
+                           .Prefetch(16)
+                           .Where([](const auto &usr) noexcept(true) { return usr.likes % 2 == 0; });
+                   auto const first = rows.Take(5).Count() + rows.Count();
+                   return first == rows.Take(5).Count() + rows.Count() ? first : 0;
+               });
+        std::size_t even = 0;
+        for (auto const &it : data)
+            even += it.likes % 2 == 0;
+        // a loader throwing on the producer thread throws from the consumer, through the
+        // stages after the Prefetch too
+        auto const thrown = test("IEnum->PrefetchThrow", [&]() {
+                   auto const prefetched = linq::make_enumerable(data)
+                           .Select([](const auto &usr) {
+                               if (usr.id == 500)
+                                   throw std::runtime_error("row 500");
+                               return usr.likes;
+                           })
+                           .Prefetch(16);
+                   auto const rethrows = [](auto const &run) {
+                       try {
+                           run();
+                       }
+                       catch (std::runtime_error const &) {
+                           return true;
+                       }
+                       return false;
+                   };
+                   return rethrows([&]() { prefetched.Count(); })
+                          && rethrows([&]() { prefetched.Where([](int const likes) noexcept(true) { return likes % 2; }).Count(); })
+                          && rethrows([&]() { prefetched.Select([](int const likes) noexcept(true) { return likes + 1; }).Count(); })
+                          && rethrows([&]() { prefetched.Skip(1).Count(); })
+                          && rethrows([&]() { prefetched.OrderBy(linq::asc([](int const likes) noexcept(true) { return likes; })).Count(); })
+                          && rethrows([&]() { prefetched.OrderBy(linq::asc([](int const likes) noexcept(true) { return likes; })).First(); })
+                          && rethrows([&]() { prefetched.All().Count(); });
+               });
+        return naive == pipelined && naive == postfix && twice == 5 + even && thrown;
+    }
+};
+template <typename T>
+struct Test<T, which::ParallelOrderBy>
+{
+    auto operator()() const
+    {
+        Context<T> context;
+        auto &data = context.get();
+
+        // order-sensitive checksum, ties keep the source order
+        auto const checksum = [](auto const &rows) noexcept(true) {
+            long result = 0, rank = 0;
+            for (const auto &it : rows)
+                result += (rank++ % 97) * it.visits;
+            return result;
+        };
+        auto const sorted = test("Naive->ParallelOrderBy", [&]() noexcept(true) {
+            auto rows = data;
+            std::stable_sort(rows.begin(), rows.end(), [](T const &l, T const &r) {
+                return l.group < r.group || (l.group == r.group && l.likes > r.likes);
+            });
+            return checksum(rows);
+        })
+               ==
+               test("IEnum->ParallelOrderBy", [&]() {
+                   return checksum(linq::make_enumerable(data)
+                           .AsParallel()
+                           .OrderBy(linq::asc([](const auto &usr) noexcept(true) { return usr.group; }),
+                                    linq::desc([](const auto &usr) noexcept(true) { return usr.likes; })));
+               });
+
+        // -0.0 and +0.0 tie whatever the row count and the path, as in std::stable_sort
+        auto const zeros = test("IEnum->OrderBySignedZero", [&]() {
+            typedef std::pair<double, std::size_t> row_t;
+            auto const key = linq::asc([](row_t const &row) noexcept(true) { return row.first; });
+            auto const order = [&key](std::size_t const size, bool const parallel) {
+                std::vector<row_t> rows;
+                for (std::size_t i = 0; i < size; ++i)
+                    rows.emplace_back(i % 3 ? (i % 2 ? -0.0 : 0.0) : (i % 2 ? -1.0 : 1.0), i);
+                auto expected = rows;
+                std::stable_sort(expected.begin(), expected.end(), [](row_t const &l, row_t const &r) {
+                    return l.first < r.first;
+                });
+                auto const source = linq::make_enumerable(rows);
+                std::vector<row_t> computed;
+                if (parallel)
+                    for (auto const &row : source.AsParallel(4).OrderBy(key))
+                        computed.push_back(row);
+                else
+                    for (auto const &row : source.OrderBy(key))
+                        computed.push_back(row);
+                return std::equal(expected.begin(), expected.end(), computed.begin(), computed.end(),
+                                  [](row_t const &l, row_t const &r) { return l.second == r.second; });
+            };
+            return order(10, false) && order(100, false) && order(1 << 17, true);
+        });
+        return sorted && zeros;
+    }
+};
+template <typename T>
+struct Test<T, which::ParallelGroupBy>
+{
+    auto operator()() const
+    {
+        Context<T> context;
+        auto &data = context.get();
+
+        // groups in order of first appearance, rows in source order
+        return test("Naive->ParallelGroupBy", [&]() {
+            std::unordered_map<int, std::size_t> index;
+            std::vector<std::vector<T const *>> groups;
+            for (const auto &it : data) {
+                auto const key = it.likes * 1024 + it.group;
+                auto const found = index.emplace(key, groups.size());
+                if (found.second)
+                    groups.emplace_back();
+                groups[found.first->second].push_back(&it);
+            }
+            long result = 0, rank = 0;
+            for (const auto &group : groups) {
+                long member = 0;
+                for (const auto *it : group)
+                    result += (rank % 97) * (member++ % 13) * it->visits;
+                ++rank;
+            }
+            return result;
+        })
+               ==
+               test("IEnum->ParallelGroupBy", [&]() {
+                   auto const groups = linq::make_enumerable(data)
+                           .AsParallel()
+                           .GroupBy([](const auto &usr) noexcept(true) { return usr.likes * 1024 + usr.group; });
+                   long result = 0, rank = 0;
+                   for (const auto &group : groups) {
+                       long member = 0;
+                       for (const auto &it : group.second)
+                           result += (rank % 97) * (member++ % 13) * it.visits;
+                       ++rank;
+                   }
+                   return result;
+               });
+    }
+};
+template <typename T>
+struct Test<T, which::Closure>
+{
+    auto operator()() const
+    {
+        Context<T> context;
+        auto &data = context.get();
+        int const lim = 100, a1 = 7, a2 = 3;
+
+        return test("Naive->Closure", [&]() noexcept(true) {
+            long result = 0;
+            int taken = 0;
+            for (auto it = data.begin(); it != data.end() && taken < 1000; ++it)
+                if (it->likes > lim + a1 + a2) {
+                    result += it->visits + a1;
+                    ++taken;
+                }
+            return result;
+        })
+               ==
+               test("IEnum->Closure", [&]() {
+                   // the query handle is gone, the iterator keeps the closures it points to
+                   auto it = linq::make_enumerable(data)
+                           .Where([lim, a1, a2](const auto &usr) noexcept(true) { return usr.likes > lim + a1 + a2; })
+                           .Select([a1, a2, lim](const auto &usr) noexcept(true) { return static_cast<long>(usr.visits + a1 + a2 + lim - a2 - lim); })
+                           .begin();
+                   long result = 0;
+                   for (int taken = 0; taken < 1000; ++taken, ++it)
+                       result += *it;
+                   return result;
+               });
+    }
+};
+template <typename T>
+struct Test<T, which::ParallelTake>
+{
+    auto operator()() const
+    {
+        Context<T> context;
+        auto &data = context.get();
+
+        return test("Naive->ParallelTake", [&]() noexcept(true) {
+            int result = 0, taken = 0;
+            for (const auto &it : data)
+                if (it.likes % 2 && ++taken <= 1000)
+                    result = it.visits;
+            return result;
+        })
+               ==
+               test("IEnum->ParallelTake", [&]() {
+                   return linq::make_enumerable(data)
+                           .AsParallel()
+                           .Where([](const auto &usr) noexcept(true) { return usr.likes % 2; })
+                           .Take(1000)
+                           .Last().visits;
+               });
+    }
+};
+template <typename T>
+struct Test<T, which::ParallelWhere>
+{
+    auto operator()() const
+    {
+        Context<T> context;
+        auto &data = context.get();
+
+        auto const filtered = test("Naive->ParallelWhere", [&]() noexcept(true) {
+            long result = 0;
+            for (const auto &it : data)
+                if (it.likes % 3)
+                    result += it.visits + 1;
+            return result;
+        })
+               ==
+               test("IEnum->ParallelWhere", [&]() {
+                   // the Where stage settles once, before the workers slice it
+                   auto const rows = linq::make_enumerable(data)
+                           .AsParallel(4)
+                           .Where([](const auto &usr) noexcept(true) { return usr.likes % 3; });
+                   auto const visits = rows.Select([](const auto &usr) noexcept(true) { return static_cast<long>(usr.visits); });
+                   return visits.Sum() + static_cast<long>(rows.Count());
+               });
+
+        // the first match of the earliest part, whichever part finds one first
+        auto const first = test("IEnum->ParallelFirst", [&]() {
+            auto const last = data.back().id;
+            auto const source = linq::make_enumerable(data).AsParallel(4);
+            auto const odd = source.Where([](const auto &usr) noexcept(true) { return usr.likes % 2; }).First();
+            auto const tail = source.Where([last](const auto &usr) noexcept(true) { return usr.id == last; }).First();
+            auto const none = source.Where([](const auto &usr) noexcept(true) { return usr.likes < 0; })
+                    .Select([](const auto &usr) noexcept(true) { return usr.id + 1; }).FirstOrDefault();
+            auto const expected = *std::find_if(data.begin(), data.end(), [](const auto &usr) { return usr.likes % 2; });
+            return odd.id == expected.id && tail.id == last && none == 0;
+        });
+        return filtered && first;
+    }
+};
+struct Team
+{
+    int id;
+    int bonus;
+};
+
+static std::vector<Team> make_teams()
+{
+    std::vector<Team> teams;
+    for (int i = 0; i < 1024; ++i)
+        teams.push_back({ i, i % 7 });
+    return teams;
+}
+
+template <typename T>
+struct Test<T, which::Join>
+{
+    auto operator()() const
+    {
+        Context<T> context;
+        auto &data = context.get();
+        auto const teams = make_teams();
+
+        auto const query = [&data, &teams]() {
+            return linq::make_enumerable(data)
+                    .Join(linq::make_enumerable(teams),
+                          [](const auto &usr) noexcept(true) { return usr.group; },
+                          [](const auto &team) noexcept(true) { return team.id; },
+                          [](const auto &usr, const auto &team) noexcept(true) { return (usr.likes & 0xff) * team.bonus; });
+        };
+        auto const expected = test("Naive->Join", [&]() noexcept(true) {
+            int result = 0;
+            for (auto const &usr : data)
+                for (auto const &team : teams)
+                    if (usr.group == team.id)
+                        result += (usr.likes & 0xff) * team.bonus;
+            return result;
+        });
+        auto const computed = test("IEnum->Join", [&]() {
+            return query().Sum();
+        });
+        // the query handle is gone, the iterators keep the hashed side
+        auto const detached = test("IEnum->JoinDetached", [&]() {
+            auto range = [&query]() {
+                auto const joined = query();
+                return std::make_pair(joined.begin(), joined.end());
+            }();
+            int result = 0;
+            for (; range.first != range.second; ++range.first)
+                result += *range.first;
+            return result;
+        });
+        return expected == computed && expected == detached;
+    }
+};
+template <typename T>
+struct Test<T, which::GroupJoin>
+{
+    auto operator()() const
+    {
+        Context<T> context;
+        auto &data = context.get();
+        auto const teams = make_teams();
+
+        auto const query = [&data, &teams]() {
+            return linq::make_enumerable(teams)
+                    .GroupJoin(linq::make_enumerable(data),
+                               [](const auto &team) noexcept(true) { return team.id; },
+                               [](const auto &usr) noexcept(true) { return usr.group; },
+                               [](const auto &, const auto &users) noexcept(true) {
+                                   int likes = 0;
+                                   for (auto const &usr : users)
+                                       likes += usr.likes;
+                                   return likes;
+                               });
+        };
+        auto const expected = test("Naive->GroupJoin", [&]() noexcept(true) {
+            std::uint64_t result = 0;
+            for (auto const &team : teams)
+            {
+                int likes = 0;
+                for (auto const &usr : data)
+                    if (usr.group == team.id)
+                        likes += usr.likes;
+                result = result * 31 + likes;
+            }
+            return result;
+        });
+        auto const computed = test("IEnum->GroupJoin", [&]() {
+            std::uint64_t result = 0;
+            query().Each([&result](int const likes) { result = result * 31 + likes; });
+            return result;
+        });
+        // the query handle is gone, the iterators keep the hashed side
+        auto const detached = test("IEnum->GroupJoinDetached", [&]() {
+            auto range = [&query]() {
+                auto const joined = query();
+                return std::make_pair(joined.begin(), joined.end());
+            }();
+            std::uint64_t result = 0;
+            for (; range.first != range.second; ++range.first)
+                result = result * 31 + *range.first;
+            return result;
+        });
+        return expected == computed && expected == detached;
+    }
+};
+template <typename T>
 struct Test<T, which::Custom>
 {
     auto operator()() const
@@ -432,7 +1795,7 @@ struct Test<T, which::Custom>
             int sum = 0;
             if (enu.Contains(10000))
                 enu.TakeWhile([](auto const &val) { return val <= 100000; }).Each([&sum](auto const &) {  ++sum; });
-            return enu.min() + enu.max()
+            return enu.Min() + enu.Max()
                    + enu.First() - enu.FirstOrDefault() +
                    + enu.Last() - enu.LastOrDefault() + sum;
 
@@ -448,25 +1811,68 @@ void executeTests()
     assertEquals(Test<int, which::Take>()(), true);
     assertEquals(Test<int, which::Skip>()(), true);
     assertEquals(Test<int, which::Where>()(), true);
+    assertEquals(Test<int, which::Range>()(), true);
+    assertEquals(Test<int, which::Repeat>()(), true);
+    assertEquals(Test<int, which::Concat>()(), true);
 
     std::cout << "# Overhead User" << std::endl;
     assertEquals(Test<User, which::Select>()(), true);
     assertEquals(Test<User, which::Take>()(), true);
     assertEquals(Test<User, which::Skip>()(), true);
+    assertEquals(Test<User, which::Deferred>()(), true);
     assertEquals(Test<User, which::Where>()(), true);
     assertEquals(Test<User, which::SelectMany>()(), true);
     assertEquals(Test<User, which::GroupBy>()(), true);
+    assertEquals(Test<User, which::GroupSum>()(), true);
     assertEquals(Test<User, which::OrderBy>()(), true);
+    assertEquals(Test<User, which::ByRef>()(), true);
+    assertEquals(Test<User, which::TopK>()(), true);
+    assertEquals(Test<User, which::Distinct>()(), true);
+    assertEquals(Test<User, which::Set>()(), true);
+    assertEquals(Test<User, which::Memoize>()(), true);
+    assertEquals(Test<User, which::Arena>()(), true);
+    assertEquals(Test<User, which::Aggregate>()(), true);
+    assertEquals(Test<User, which::Soa>()(), true);
+    assertEquals(Test<User, which::File>()(), true);
+    assertEquals(Test<User, which::Chunk>()(), true);
+    assertEquals(Test<User, which::Prefetch>()(), true);
+    assertEquals(Test<User, which::ParallelOrderBy>()(), true);
+    assertEquals(Test<User, which::ParallelGroupBy>()(), true);
+    assertEquals(Test<User, which::Closure>()(), true);
+    assertEquals(Test<User, which::ParallelTake>()(), true);
+    assertEquals(Test<User, which::ParallelWhere>()(), true);
+    assertEquals(Test<User, which::Join>()(), true);
+    assertEquals(Test<User, which::GroupJoin>()(), true);
     assertEquals(Test<User, which::Custom>()(), 200001);
 
     std::cout << "# Overhead Random User" << std::endl;
     assertEquals(Test<UserRandom, which::Select>()(), true);
     assertEquals(Test<UserRandom, which::Take>()(), true);
     assertEquals(Test<UserRandom, which::Skip>()(), true);
+    assertEquals(Test<UserRandom, which::Deferred>()(), true);
     assertEquals(Test<UserRandom, which::Where>()(), true);
     assertEquals(Test<UserRandom, which::SelectMany>()(), true);
     assertEquals(Test<UserRandom, which::GroupBy>()(), true);
+    assertEquals(Test<UserRandom, which::GroupSum>()(), true);
     assertEquals(Test<UserRandom, which::OrderBy>()(), true);
+    assertEquals(Test<UserRandom, which::ByRef>()(), true);
+    assertEquals(Test<UserRandom, which::TopK>()(), true);
+    assertEquals(Test<UserRandom, which::Distinct>()(), true);
+    assertEquals(Test<UserRandom, which::Set>()(), true);
+    assertEquals(Test<UserRandom, which::Memoize>()(), true);
+    assertEquals(Test<UserRandom, which::Arena>()(), true);
+    assertEquals(Test<UserRandom, which::Aggregate>()(), true);
+    assertEquals(Test<UserRandom, which::Soa>()(), true);
+    assertEquals(Test<UserRandom, which::File>()(), true);
+    assertEquals(Test<UserRandom, which::Chunk>()(), true);
+    assertEquals(Test<UserRandom, which::Prefetch>()(), true);
+    assertEquals(Test<UserRandom, which::ParallelOrderBy>()(), true);
+    assertEquals(Test<UserRandom, which::ParallelGroupBy>()(), true);
+    assertEquals(Test<UserRandom, which::Closure>()(), true);
+    assertEquals(Test<UserRandom, which::ParallelTake>()(), true);
+    assertEquals(Test<UserRandom, which::ParallelWhere>()(), true);
+    assertEquals(Test<UserRandom, which::Join>()(), true);
+    assertEquals(Test<UserRandom, which::GroupJoin>()(), true);
     assertEquals(Test<UserRandom, which::Custom>()(), 200001);
 }
 